@@ -0,0 +1,140 @@
+/*
+ * Copyright(C) 2014 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of MyLib.
+ *
+ * MyLib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MyLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MyLib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file
+ * 
+ * @brief Artificial Intelligence Library
+ */
+
+#ifndef AI_H_
+#define AI_H_
+
+	#include "array.h"
+	#include "vector.h"
+	
+	/*========================================================================*
+	 *                           Search Algorithms                            *
+	 *========================================================================*/
+	 
+	/**
+	 * @brief A world state.
+	 */
+	typedef void * state_t;
+	
+	/**
+	 * @defgroup search Search Algorithms
+	 */
+	/**@{*/
+
+	/**
+	 * @brief A search problem.
+	 */
+	struct search_problem
+	{
+		state_t initial;             /**< Initial state.       */
+		bool (*is_goal)(state_t);    /**< Goal test.           */
+		array_t (*next)(state_t);    /**< Generate next state. */
+		double (*evaluate)(state_t); /**< Evaluates a state.   */
+	};
+	
+	/**@}*/
+
+	/*========================================================================*
+	 *                           Genetic Algorithm                            *
+	 *========================================================================*/
+
+	/**
+	 * @brief Opaque pointer to gene.
+	 */
+	typedef void * gene_t;
+	
+	/**
+	 * @defgroup GA Genetic Algorithm
+	 */
+	/**@{*/
+
+	/**
+	 * @brief Genome.
+	 */
+	struct genome
+	{
+		/**
+		 * @name Attributes
+		 */
+		/**@{*/
+		double m_rate;  /**< Mutation rate.    */
+		double c_rate;  /**< Crossover rate.   */
+		double e_rate;  /**< Elitism rate.     */
+		double r_rate;  /**< Replacement rate. */
+		int tournament; /**< Tournament size.  */
+		/**@}*/
+		
+		/**
+		 * @name Operations.
+		 */
+		/**@{*/
+		gene_t (*generate)(void);                 /**< Generates a gene.    */
+		double (*evaluate)(gene_t);               /**< Evaluation function. */
+		gene_t (*crossover)(gene_t, gene_t, int); /**< Crossover operator.  */
+		gene_t (*mutation)(gene_t);               /**< Mutation operator.   */
+		void (*destroy)(gene_t);                  /**< Destroys a gene.     */
+		/**@}*/
+	};
+	
+	/**
+	 * @brief Genetic algorithm options.
+	 */
+	enum ga_options
+	{
+		GA_OPTIONS_STATISTICS     = (1 << 0), /**< Get statistics.           */
+		GA_OPTIONS_CONVERGE       = (1 << 1), /**< Run until convergence.    */
+		GA_OPTIONS_USE_SEED       = (1 << 2), /**< Use seed organism.        */
+		GA_OPTIONS_USE_TOURNAMENT = (1 << 3)  /**< Use tournament selection. */
+	};
+	
+	/**@}*/
+	
+	/* Forward definitions. */
+	extern gene_t genetic_algorithm(const struct genome*, unsigned, unsigned, enum ga_options, ...);
+
+	/*========================================================================*
+	 *                            Kmeans Algorithm                            *
+	 *========================================================================*/
+	
+	/**
+	 * @brief Kmeans data.
+	 */
+	struct kmeans_data
+	{
+		int *map;             /**< Cluster map.         */
+		int npoints;          /**< Number of points.    */
+		int ncentroids;       /**< Number of centroids. */
+		const vector_t *data; /**< Data points.         */
+		vector_t *centroids;  /**< Centroids.           */
+	};
+	
+	/* Forward definitions. */
+	extern struct kmeans_data *kmeans(const vector_t *, int, int, double);
+	extern int kmeans_count_points(const int *, int, int);
+	extern int kmeans_count_centroids(const int *, int);
+	extern double *kmeans_average_distance(const vector_t *, int, const vector_t *, int, int *);
+	extern void kmeans_data_destroy(struct kmeans_data *);
+
+#endif /* AI_H_ */
@@ -0,0 +1,33 @@
+/*
+ * Copyright(C) 2014-2015 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of MyLib.
+ *
+ * MyLib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MyLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MyLib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file
+ * 
+ * @brief Algorithms Library
+ */
+
+#ifndef ALGORITHMS_H_
+#define ALGORITHMS_H_
+
+	#include "matrix.h"
+
+	extern int *auction(matrix_t, double);
+
+#endif /* ALGORITHMS_H_ */
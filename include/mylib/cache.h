@@ -0,0 +1,96 @@
+/*
+ * Copyright(C) 2015 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of MyLib.
+ *
+ * MyLib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MyLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MyLib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file
+ *
+ * @brief Cache library.
+ */
+
+#ifndef CACHE_H_
+#define CACHE_H_
+
+	#include <stdio.h>
+
+	#include "hash.h"
+	#include "list.h"
+	#include "object.h"
+
+	/*========================================================================*
+	 *                              Private Interface                         *
+	 *========================================================================*/
+
+	/**
+	 * @brief Block flags.
+	 */
+	/**@{*/
+	#define BLOCK_VALID (1 << 0) /**< Valid block? */
+	#define BLOCK_DIRTY (1 << 1) /**< Dirty block? */
+	/**@}*/
+
+	/**
+	 * @brief Cache block.
+	 */
+	struct block
+	{
+		object_t obj;   /**< Underlying object.   */
+		unsigned flags; /**< Flags (see above).   */
+		unsigned age;   /**< Age.                 */
+		unsigned addr;  /**< Address.             */
+		long off;       /**< Offset in swap file. */
+	};
+
+	/**
+	 * @brief Cache.
+	 */
+	struct cache
+	{
+		FILE *swp;                  /**< Swap file.           */
+		list_t free;                /**< List of free blocks. */
+		hash_t used;                /**< Used blocks.         */
+		unsigned age;               /**< Current age.         */
+		struct block *blocks;       /**< Cache blocks.        */
+		unsigned size;              /**< Size (in blocks).    */
+		const struct objinfo *info; /**< Object information.  */
+	};
+	
+	/**
+	 * @brief Opaque pointer to a cache.
+	 */
+	typedef struct cache * cache_t;
+
+	/**
+	 * @brief Opaque pointer to a constant cache.
+	 */
+	typedef const struct cache * const_cache_t;
+
+	/*=======================================================================*
+	 *                              Public Interface                         *
+	 *=======================================================================*/
+	
+	/* Forward definitions. */
+	extern cache_t cache_create(const struct objinfo *, FILE *, unsigned);
+	extern void cache_destroy(cache_t);
+	extern void cache_insert(cache_t, object_t);
+	extern void cache_update(cache_t, object_t);
+	extern object_t cache_get(cache_t, unsigned);
+	extern object_t cache_remove(cache_t, unsigned);
+	extern void cache_flush(struct cache *);
+
+#endif /* CACHE_H_ */
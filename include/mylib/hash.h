@@ -0,0 +1,69 @@
+/*
+ * Copyright(C) 2015 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of MyLib.
+ *
+ * MyLib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MyLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MyLib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file
+ *
+ * @brief Hash table library.
+ */
+
+#ifndef HASH_H_
+#define HASH_H_
+
+	#include <assert.h>
+	
+	#include "list.h"
+	#include "object.h"
+
+	/*========================================================================*
+	 *                              Private Interface                         *
+	 *========================================================================*/
+
+	/**
+	 * @brief Hash table.
+	 */
+	struct hash
+	{
+		list_t *table;              /**< Hash table.         */
+		unsigned size;              /**< Hash table size.    */
+		const struct objinfo *info; /**< Object information. */
+	};
+
+	/**
+	 * @brief Opaque pointer to a hash table.
+	 */
+	typedef struct hash * hash_t;
+
+	/**
+	 * @brief Opaque pointer to a constant hash table.
+	 */
+	typedef const struct hash * const_hash_t;
+
+	/*=======================================================================*
+	 *                              Public Interface                         *
+	 *=======================================================================*/
+	
+	/* Forward definitions. */
+	extern hash_t hash_create(const struct objinfo *, unsigned);
+	extern void hash_destroy(hash_t);
+	extern void hash_insert(hash_t, object_t);
+	extern object_t hash_remove(hash_t, unsigned);
+	extern object_t hash_get(hash_t, unsigned);
+
+#endif /* HASH_H_ */
@@ -23,6 +23,7 @@ INDIR=examples
 OUTDIR=output
 
 # Tools.
+COMM2BIN="$BINDIR/comm2bin"
 MAP2NAS="$BINDIR/map2nas"
 MAPPER="$BINDIR/mapper --verbose"
 NAS2TPZ="$BINDIR/nas2tpz"
@@ -44,11 +45,9 @@ function run_kmeans
 	nasfile="$OUTDIR/kmeans-$1-$3.trace"
 	tpzfile="$OUTDIR/kmeans-$1-$3.tpz.trace"
 	
-	cut -d" " -f2- $tracefile > input
-	
 	# Build command.
 	topology="--topology $2"
-	infile="--input input"
+	infile="--input $OUTDIR/$3-$1.bin"
 	cmd="$MAPPER $topology $infile --kmeans $NCLUSTERS"
 	
 	output=$(($cmd 1> $mapfile) 2>&1)
@@ -63,9 +62,6 @@ function run_kmeans
 		$MAP2NAS $tracefile $mapfile > $nasfile
 		$NAS2TPZ $nasfile $1 $2 > $tpzfile
 	fi
-	
-	# House keeping.
-	rm -f input
 }
 
 #
@@ -81,11 +77,9 @@ function run_hierarchical
 	nasfile="$OUTDIR/hierarchical-$1-$3.trace"
 	tpzfile="$OUTDIR/hierarchical-$1-$3.tpz.trace"
 	
-	cut -d" " -f2- $tracefile > input
-	
 	# Build command.
 	topology="--topology $2"
-	infile="--input input"
+	infile="--input $OUTDIR/$3-$1.bin"
 	cmd="$MAPPER $topology $infile --hierarchical"
 	
 	output=$(($cmd 1> $mapfile) 2>&1)
@@ -100,9 +94,6 @@ function run_hierarchical
 		$MAP2NAS $tracefile $mapfile > $nasfile
 		$NAS2TPZ $nasfile $1 $2 > $tpzfile
 	fi
-	
-	# House keeping.
-	rm -f input
 }
 
 #
@@ -118,11 +109,9 @@ function run_greedy
 	nasfile="$OUTDIR/greedy-$1-$3.trace"
 	tpzfile="$OUTDIR/greedy-$1-$3.tpz.trace"
 	
-	cut -d" " -f2- $tracefile > input
-	
 	# Build command.
 	topology="--topology $2"
-	infile="--input input"
+	infile="--input $OUTDIR/$3-$1.bin"
 	cmd="$MAPPER $topology $infile --greedy"
 	
 	output=$(($cmd 1> $mapfile) 2>&1)
@@ -137,9 +126,16 @@ function run_greedy
 		$MAP2NAS $tracefile $mapfile > $nasfile
 		$NAS2TPZ $nasfile $1 $2 > $tpzfile
 	fi
-	
-	# House keeping.
-	rm -f input
+}
+
+#
+# Converts a NAS trace file to the binary communication format.
+#  $1 Number of processes.
+#  $2 Kernel.
+#
+function convert
+{
+	$COMM2BIN --nas "$INDIR/$2/$1.trace" "$OUTDIR/$2-$1.bin"
 }
 
 kernels=( CG EP FT IS MG )
@@ -148,6 +144,10 @@ mkdir -p $OUTDIR
 rm -rf $OUTDIR/*
 
 for i in {0..4}; do
+	convert           32       ${kernels[$i]}
+	convert           64       ${kernels[$i]}
+	convert          128       ${kernels[$i]}
+	convert          256       ${kernels[$i]}
 	run_kmeans        32   4x8 ${kernels[$i]}
 	run_hierarchical  32   4x8 ${kernels[$i]}
 	run_greedy        32   4x8 ${kernels[$i]}
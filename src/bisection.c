@@ -0,0 +1,515 @@
+/*
+ * Copyright(C) 2015 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Mapper.
+ *
+ * Mapper is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Mapper is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MyLib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <mylib/util.h>
+
+#include "heap.h"
+#include "mapper.h"
+
+/**
+ * @brief Maximum number of refinement passes per bisection.
+ */
+#define BISECTION_MAX_PASSES 8
+
+/**
+ * @brief Maximum number of moves without improvement in a refinement pass.
+ */
+#define BISECTION_MAX_FRUITLESS 64
+
+/**
+ * @brief Dual recursive bisection state.
+ */
+struct bisection
+{
+	const struct graph *g;        /**< Communication graph.                */
+	const struct processor *proc; /**< Processor's topology.               */
+	int *map;                     /**< Process map.                        */
+	int *domain;                  /**< Center core of part of processes.   */
+	unsigned *mark;               /**< Part stamps of processes.           */
+	unsigned stamp;               /**< Stamp of current part.              */
+	char *side;                   /**< Side of processes in current part.  */
+	double *external[2];          /**< Cost of processes out of each side. */
+	int *queue;                   /**< Scratch list of processes.          */
+	int *moves;                   /**< Moves of current pass.              */
+	struct heap *heaps[2];        /**< Gains of processes on each side.    */
+};
+
+/**
+ * @brief Asserts if a process belongs to the current part.
+ */
+static inline bool inside(const struct bisection *b, int i)
+{
+	return (b->mark[i] == b->stamp);
+}
+
+/**
+ * @brief Computes the cost of placing processes on each side.
+ *
+ * @details The cost of a side accounts for the communication with processes
+ *          out of the current part, which are assumed to lie on the center
+ *          core of their own part.
+ *
+ * @param b     Dual recursive bisection state.
+ * @param procs Processes of current part.
+ * @param np    Number of processes.
+ * @param c0    Center core of lower side.
+ * @param c1    Center core of upper side.
+ */
+static void externals(struct bisection *b, const int *procs, int np, int c0, int c1)
+{
+	const struct graph *g = b->g;
+
+	for (int p = 0; p < np; p++)
+	{
+		int i = procs[p];
+
+		b->external[0][i] = b->external[1][i] = 0.0;
+		for (int k = g->offsets[i]; k < g->offsets[i + 1]; k++)
+		{
+			int j = g->adjacency[k];
+
+			if (inside(b, j))
+				continue;
+
+			b->external[0][i] += g->weights[k]*processor_distance(b->proc, c0, b->domain[j]);
+			b->external[1][i] += g->weights[k]*processor_distance(b->proc, c1, b->domain[j]);
+		}
+	}
+}
+
+/**
+ * @brief Looks for a peripheral process of the current part.
+ *
+ * @details Runs a breadth-first search from @p i and returns the process
+ *          that is visited last.
+ */
+static int peripheral(struct bisection *b, int i)
+{
+	int head, tail;
+	const struct graph *g = b->g;
+
+	/* Processes that are visited are moved to the upper side. */
+	head = tail = 0;
+	b->queue[tail++] = i;
+	b->side[i] = 1;
+	while (head < tail)
+	{
+		i = b->queue[head++];
+
+		for (int k = g->offsets[i]; k < g->offsets[i + 1]; k++)
+		{
+			int j = g->adjacency[k];
+
+			if ((inside(b, j)) && (b->side[j] == 0))
+			{
+				b->side[j] = 1;
+				b->queue[tail++] = j;
+			}
+		}
+	}
+
+	return (i);
+}
+
+/**
+ * @brief Grows the lower side of a bisection.
+ *
+ * @details Starts from the process that is most attracted to the lower side,
+ *          or from a peripheral process if there is none, and repeatedly
+ *          moves to the lower side the process that is most strongly tied
+ *          to it. Disconnected processes are taken in order.
+ *
+ * @param b     Dual recursive bisection state.
+ * @param procs Processes of current part.
+ * @param np    Number of processes.
+ * @param n0    Number of processes in the lower side.
+ * @param cut   Cost of a cut edge.
+ */
+static void grow(struct bisection *b, const int *procs, int np, int n0, double cut)
+{
+	int seed;    /* First process.   */
+	int next;    /* Next candidate.  */
+	double pull; /* Best attraction. */
+	struct heap *frontier = b->heaps[0];
+	const struct graph *g = b->g;
+
+	/* Process most attracted to the lower side. */
+	seed = procs[0];
+	pull = b->external[1][seed] - b->external[0][seed];
+	for (int p = 1; p < np; p++)
+	{
+		int i = procs[p];
+
+		if (b->external[1][i] - b->external[0][i] > pull)
+			seed = i, pull = b->external[1][i] - b->external[0][i];
+	}
+	for (int p = 0; p < np; p++)
+		b->side[procs[p]] = 0;
+	if (pull <= 0.0)
+		seed = peripheral(b, procs[0]);
+	for (int p = 0; p < np; p++)
+		b->side[procs[p]] = 1;
+
+	next = 0;
+	heap_insert(frontier, seed, 0.0);
+	for (int size = 0; size < n0; size++)
+	{
+		int i;
+
+		/* Disconnected process. */
+		if (heap_empty(frontier))
+		{
+			while (b->side[procs[next]] == 0)
+				next++;
+			heap_insert(frontier, procs[next], 0.0);
+		}
+
+		i = heap_pop(frontier);
+		b->side[i] = 0;
+
+		for (int k = g->offsets[i]; k < g->offsets[i + 1]; k++)
+		{
+			int j = g->adjacency[k];
+
+			if ((!inside(b, j)) || (b->side[j] == 0))
+				continue;
+
+			if (heap_contains(frontier, j))
+				heap_update(frontier, j, heap_key(frontier, j) + g->weights[k]*cut);
+			else
+				heap_insert(frontier, j, g->weights[k]*cut + b->external[1][j] - b->external[0][j]);
+		}
+	}
+
+	/* House keeping. */
+	while (!heap_empty(frontier))
+		heap_pop(frontier);
+}
+
+/**
+ * @brief Computes the gain of moving a process to the other side.
+ */
+static double gain(const struct bisection *b, int i, double cut)
+{
+	int s = b->side[i];
+	double sum = b->external[s][i] - b->external[!s][i];
+	const struct graph *g = b->g;
+
+	for (int k = g->offsets[i]; k < g->offsets[i + 1]; k++)
+	{
+		int j = g->adjacency[k];
+
+		if ((j == i) || (!inside(b, j)))
+			continue;
+
+		sum += (b->side[j] == s) ? -g->weights[k]*cut : g->weights[k]*cut;
+	}
+
+	return (sum);
+}
+
+/**
+ * @brief Refines a bisection with Fiduccia-Mattheyses passes.
+ *
+ * @details In each pass, processes are moved one at a time to the other
+ *          side, always taking the move of largest gain, and each process
+ *          moves at most once. Sides may exceed their bounds by a single
+ *          process, so that moves from both sides can alternate. The pass
+ *          is then rolled back to its best prefix that respects the bounds.
+ *
+ * @param b     Dual recursive bisection state.
+ * @param procs Processes of current part.
+ * @param np    Number of processes.
+ * @param n0    Number of processes in the lower side.
+ * @param lo    Minimum number of processes in the lower side.
+ * @param hi    Maximum number of processes in the lower side.
+ * @param cut   Cost of a cut edge.
+ */
+static void refine_bisection
+(struct bisection *b, const int *procs, int np, int n0, int lo, int hi, double cut)
+{
+	const struct graph *g = b->g;
+
+	for (int pass = 0; pass < BISECTION_MAX_PASSES; pass++)
+	{
+		int size;       /* Processes in lower side. */
+		int nmoves;     /* Moves taken.             */
+		int best;       /* Moves in best prefix.    */
+		double total;   /* Gain of moves taken.     */
+		double maxgain; /* Gain of best prefix.     */
+
+		for (int p = 0; p < np; p++)
+		{
+			int i = procs[p];
+
+			heap_insert(b->heaps[(int)b->side[i]], i, gain(b, i, cut));
+		}
+
+		size = n0;
+		nmoves = best = 0;
+		total = maxgain = 0.0;
+		while (nmoves - best < BISECTION_MAX_FRUITLESS)
+		{
+			int i, s;
+
+			/* Pick best legal move. */
+			s = -1;
+			if ((!heap_empty(b->heaps[0])) && (size > lo - 1))
+				s = 0;
+			if ((!heap_empty(b->heaps[1])) && (size < hi + 1))
+			{
+				if ((s < 0) || (heap_key(b->heaps[1], heap_top(b->heaps[1])) > heap_key(b->heaps[0], heap_top(b->heaps[0]))))
+					s = 1;
+			}
+			if (s < 0)
+				break;
+
+			total += heap_key(b->heaps[s], heap_top(b->heaps[s]));
+			i = heap_pop(b->heaps[s]);
+			b->side[i] = !s;
+			size += (s == 0) ? -1 : 1;
+			b->moves[nmoves++] = i;
+
+			/* Update gains of neighbors. */
+			for (int k = g->offsets[i]; k < g->offsets[i + 1]; k++)
+			{
+				int j = g->adjacency[k];
+				struct heap *h = b->heaps[(int)b->side[j]];
+
+				if ((j == i) || (!inside(b, j)) || (!heap_contains(h, j)))
+					continue;
+
+				heap_update(h, j, heap_key(h, j) + ((b->side[j] == s) ? 2 : -2)*g->weights[k]*cut);
+			}
+
+			if ((size >= lo) && (size <= hi) && (total > maxgain))
+				best = nmoves, maxgain = total, n0 = size;
+		}
+
+		/* Roll back to best prefix. */
+		while (nmoves > best)
+		{
+			int i = b->moves[--nmoves];
+
+			b->side[i] = !b->side[i];
+		}
+
+		/* House keeping. */
+		while (!heap_empty(b->heaps[0]))
+			heap_pop(b->heaps[0]);
+		while (!heap_empty(b->heaps[1]))
+			heap_pop(b->heaps[1]);
+
+		if (best == 0)
+			break;
+	}
+}
+
+/**
+ * @brief Places a single process on its best core.
+ */
+static void place_single(struct bisection *b, int i, const struct corekey *cores, int nc)
+{
+	int best;        /* Best core.         */
+	double bestcost; /* Cost of best core. */
+	const struct graph *g = b->g;
+
+	best = -1;
+	bestcost = 0.0;
+	for (int c = 0; c < nc; c++)
+	{
+		double cost = 0.0;
+
+		for (int k = g->offsets[i]; k < g->offsets[i + 1]; k++)
+		{
+			int j = g->adjacency[k];
+
+			if (j != i)
+				cost += g->weights[k]*processor_distance(b->proc, cores[c].core, b->domain[j]);
+		}
+
+		if ((best < 0) || (cost < bestcost))
+			best = cores[c].core, bestcost = cost;
+	}
+
+	b->map[i] = b->domain[i] = best;
+}
+
+/**
+ * @brief Bisects a part of processes along with its cores.
+ *
+ * @details Cores are cut in halves first, so that the cost of cut edges and
+ *          the attraction of each side are known when processes are cut.
+ *
+ * @param b     Dual recursive bisection state.
+ * @param procs Processes.
+ * @param np    Number of processes.
+ * @param cores Cores.
+ * @param nc    Number of cores.
+ */
+static void bisect(struct bisection *b, int *procs, int np, struct corekey *cores, int nc)
+{
+	int nc0;    /* Cores in lower side.     */
+	int np0;    /* Processes in lower side. */
+	int lo, hi; /* Bounds of lower side.    */
+	int c0, c1; /* Center cores of sides.   */
+	double cut; /* Cost of a cut edge.      */
+	int *upper; /* Processes in upper side. */
+
+	if (np == 0)
+		return;
+	if (np == 1)
+	{
+		place_single(b, procs[0], cores, nc);
+		return;
+	}
+
+	/* Bisect cores. */
+	nc0 = nc/2;
+	processor_order(b->proc, cores, nc, nc0);
+	c0 = cores[nc0/2].core;
+	c1 = cores[nc0 + (nc - nc0)/2].core;
+	cut = processor_distance(b->proc, c0, c1);
+	if (cut <= 0.0)
+		cut = 1.0;
+
+	/* Lower side gets its share of processes. */
+	lo = (np > nc - nc0) ? np - (nc - nc0) : 0;
+	hi = (np < nc0) ? np : nc0;
+	np0 = (int)(((long long)np*nc0 + nc/2)/nc);
+	if (np0 < lo)
+		np0 = lo;
+	if (np0 > hi)
+		np0 = hi;
+
+	/* Bisect processes. */
+	b->stamp++;
+	for (int p = 0; p < np; p++)
+		b->mark[procs[p]] = b->stamp;
+	externals(b, procs, np, c0, c1);
+	grow(b, procs, np, np0, cut);
+	refine_bisection(b, procs, np, np0, lo, hi, cut);
+
+	/* Split processes. */
+	upper = b->queue;
+	np0 = 0;
+	for (int p = 0; p < np; p++)
+	{
+		int i = procs[p];
+
+		if (b->side[i] == 0)
+		{
+			procs[np0++] = i;
+			b->domain[i] = c0;
+		}
+		else
+		{
+			upper[p - np0] = i;
+			b->domain[i] = c1;
+		}
+	}
+	memcpy(&procs[np0], upper, (np - np0)*sizeof(int));
+
+	/* Sanity check. */
+	assert((np0 >= lo) && (np0 <= hi));
+
+	bisect(b, procs, np0, cores, nc0);
+	bisect(b, procs + np0, np - np0, cores + nc0, nc - nc0);
+}
+
+/**
+ * @brief Maps processes using dual recursive bisection.
+ *
+ * @details The communication graph and the processor are bisected together:
+ *          each half of the processes goes to its half of the cores, until
+ *          single processes are left. Processes are split by graph growing
+ *          followed by Fiduccia-Mattheyses min-cut refinement, and the cost
+ *          of a cut edge is the distance between both halves of the cores.
+ *          Communication with processes out of the current part is charged
+ *          to the side closer to their own part, so parts stay close to
+ *          their partners. Each bisection costs O(E log n) on its part,
+ *          and each level of the recursion splits the whole graph once.
+ *
+ * @param communication Communication graph.
+ * @param args          Additional arguments.
+ *
+ * @returns A process map.
+ */
+int *map_bisection(const struct graph *communication, void *args)
+{
+	int nprocs;             /* Number of processes.   */
+	int *procs;             /* Processes.             */
+	struct corekey *cores;  /* Cores.                 */
+	struct processor *proc; /* Processor's topology.  */
+	struct bisection b;     /* Bisection state.       */
+
+	/* Sanity check. */
+	assert(communication != NULL);
+	assert(args != NULL);
+
+	/* Extract arguments. */
+	proc = ((struct bisection_args *)args)->proc;
+
+	nprocs = communication->nvertices;
+
+	if (nprocs > proc->ncores)
+		error("too many processes");
+
+	b.g = communication;
+	b.proc = proc;
+	b.map = smalloc(nprocs*sizeof(int));
+	b.domain = smalloc(nprocs*sizeof(int));
+	b.mark = scalloc(nprocs, sizeof(unsigned));
+	b.stamp = 0;
+	b.side = smalloc(nprocs*sizeof(char));
+	b.external[0] = smalloc(nprocs*sizeof(double));
+	b.external[1] = smalloc(nprocs*sizeof(double));
+	b.queue = smalloc(nprocs*sizeof(int));
+	b.moves = smalloc(nprocs*sizeof(int));
+	b.heaps[0] = heap_create(nprocs);
+	b.heaps[1] = heap_create(nprocs);
+
+	procs = smalloc(nprocs*sizeof(int));
+	for (int i = 0; i < nprocs; i++)
+		procs[i] = i, b.domain[i] = 0;
+	cores = smalloc(proc->ncores*sizeof(struct corekey));
+	for (int i = 0; i < proc->ncores; i++)
+		cores[i].core = i, cores[i].key = 0;
+
+	bisect(&b, procs, nprocs, cores, proc->ncores);
+
+	/* House keeping. */
+	heap_destroy(b.heaps[1]);
+	heap_destroy(b.heaps[0]);
+	free(b.moves);
+	free(b.queue);
+	free(b.external[1]);
+	free(b.external[0]);
+	free(b.side);
+	free(b.mark);
+	free(b.domain);
+	free(cores);
+	free(procs);
+
+	return (b.map);
+}
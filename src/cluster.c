@@ -0,0 +1,541 @@
+/*
+ * Copyright(C) 2015 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Mapper.
+ *
+ * Mapper is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Mapper is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MyLib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <assert.h>
+#include <math.h>
+#include <omp.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <mylib/util.h>
+
+#include "cluster.h"
+
+/**
+ * @brief Maximum number of iterations of kmeans.
+ */
+#define KMEANS_MAX_ITERATIONS 100
+
+/**
+ * @brief Kmeans clustering context.
+ * 
+ * @details Holds all the state of a clustering, so that clusterings do not
+ *          share anything but their (read-only) data points.
+ */
+struct kmeans_context
+{
+	struct clustering *c;       /**< Clustering.                              */
+	unsigned *stream;           /**< Private random stream.                   */
+	int *from;                  /**< Previous centroid of each point.         */
+	int *moved;                 /**< Points that changed centroid.            */
+	double *upper;              /**< Upper bound on distance to closest one.  */
+	double *lower;              /**< Lower bound on distance to second one.   */
+	double *sums;               /**< Sum of the points of each centroid.      */
+	struct features *previous;  /**< Previous location of each centroid.      */
+	int *population;            /**< Number of points of each centroid.       */
+	double *shift;              /**< Last move of each centroid.              */
+	double *half;               /**< Half distance to closest other centroid. */
+};
+
+/**
+ * @brief Creates a kmeans clustering context.
+ */
+static struct kmeans_context *kmeans_context_create
+(const struct features *points, const int *ids, int npoints, int ncentroids, unsigned *stream)
+{
+	struct clustering *c;       /* Clustering.     */
+	struct kmeans_context *ctx; /* Kmeans context. */
+	
+	c = smalloc(sizeof(struct clustering));
+	c->npoints = npoints;
+	c->ncentroids = ncentroids;
+	c->points = points;
+	c->ids = ids;
+	c->centroids = features_create(ncentroids, points->dimension);
+	c->map = smalloc(npoints*sizeof(int));
+	
+	ctx = smalloc(sizeof(struct kmeans_context));
+	ctx->c = c;
+	ctx->stream = stream;
+	ctx->from = smalloc(npoints*sizeof(int));
+	ctx->moved = smalloc(npoints*sizeof(int));
+	ctx->upper = smalloc(npoints*sizeof(double));
+	ctx->lower = smalloc(npoints*sizeof(double));
+	ctx->sums = scalloc((size_t)ncentroids*points->stride, sizeof(double));
+	ctx->previous = features_create(ncentroids, points->dimension);
+	ctx->population = scalloc(ncentroids, sizeof(int));
+	ctx->shift = scalloc(ncentroids, sizeof(double));
+	ctx->half = scalloc(ncentroids, sizeof(double));
+	
+	return (ctx);
+}
+
+/**
+ * @brief Destroys a kmeans clustering context.
+ * 
+ * @returns The clustering.
+ */
+static struct clustering *kmeans_context_destroy(struct kmeans_context *ctx)
+{
+	struct clustering *c = ctx->c;
+	
+	/* House keeping. */
+	free(ctx->half);
+	free(ctx->shift);
+	free(ctx->population);
+	features_destroy(ctx->previous);
+	free(ctx->sums);
+	free(ctx->lower);
+	free(ctx->upper);
+	free(ctx->moved);
+	free(ctx->from);
+	free(ctx);
+	
+	return (c);
+}
+
+/**
+ * @brief Destroys a clustering.
+ * 
+ * @param c Target clustering.
+ */
+void clustering_destroy(struct clustering *c)
+{
+	/* Sanity check. */
+	assert(c != NULL);
+	
+	features_destroy(c->centroids);
+	free(c->map);
+	free(c);
+}
+
+/**
+ * @brief Returns a centroid of a clustering.
+ */
+static inline float *centroid(const struct kmeans_context *ctx, int j)
+{
+	return (features_row(ctx->c->centroids, j));
+}
+
+/**
+ * @brief Returns the distance between a point and a centroid.
+ */
+static inline double distance(const struct kmeans_context *ctx, int i, int j)
+{
+	return (features_distance(ctx->c->points, clustering_point(ctx->c, i), centroid(ctx, j)));
+}
+
+/**
+ * @brief Chooses initial centroids with kmeans++ (D^2 sampling).
+ * 
+ * @param ctx     Kmeans context.
+ * @param sample  Points to choose from.
+ * @param nsample Number of points to choose from.
+ */
+static void kmeans_plusplus(struct kmeans_context *ctx, const int *sample, int nsample)
+{
+	double *mindist;       /* Distance to closest center. */
+	size_t rowsize;        /* Size of a row.              */
+	struct clustering *c;  /* Clustering.                 */
+	
+	c = ctx->c;
+	rowsize = c->points->stride*sizeof(float);
+	mindist = smalloc(nsample*sizeof(double));
+	
+	memcpy(centroid(ctx, 0), clustering_point(c, sample[rand_next(ctx->stream)%nsample]), rowsize);
+	for (int i = 0; i < nsample; i++)
+		mindist[i] = distance(ctx, sample[i], 0);
+	for (int j = 1; j < c->ncentroids; j++)
+	{
+		int next;
+		double sum, arrow;
+		
+		sum = 0.0;
+		for (int i = 0; i < nsample; i++)
+			sum += mindist[i]*mindist[i];
+		
+		/* Draw a point with probability proportional to D^2. */
+		next = rand_next(ctx->stream)%nsample;
+		arrow = rand_uniform(ctx->stream)*sum;
+		for (int i = 0; (sum > 0.0) && (i < nsample); i++)
+		{
+			if ((arrow -= mindist[i]*mindist[i]) < 0.0)
+			{
+				next = i;
+				break;
+			}
+		}
+		
+		memcpy(centroid(ctx, j), clustering_point(c, sample[next]), rowsize);
+		#pragma omp parallel for schedule(static) if ((nsample >= KMEANS_PARALLEL_MIN) && (!omp_in_parallel()))
+		for (int i = 0; i < nsample; i++)
+		{
+			double d = distance(ctx, sample[i], j);
+			
+			if (d < mindist[i])
+				mindist[i] = d;
+		}
+	}
+	
+	/* House keeping. */
+	free(mindist);
+}
+
+/**
+ * @brief Returns the closest centroid to a point.
+ */
+static inline int kmeans_nearest(const struct kmeans_context *ctx, int i)
+{
+	int best = 0;
+	double bestdist = distance(ctx, i, 0);
+	
+	for (int j = 1; j < ctx->c->ncentroids; j++)
+	{
+		double d = distance(ctx, i, j);
+		
+		if (d < bestdist)
+			best = j, bestdist = d;
+	}
+	
+	return (best);
+}
+
+/**
+ * @brief Assigns a point to its closest centroid, and resets its bounds.
+ */
+static void kmeans_scan(struct kmeans_context *ctx, int i)
+{
+	int best;      /* Closest centroid.     */
+	double d1, d2; /* Two lowest distances. */
+	
+	best = 0;
+	d1 = distance(ctx, i, 0);
+	d2 = HUGE_VAL;
+	for (int j = 1; j < ctx->c->ncentroids; j++)
+	{
+		double d = distance(ctx, i, j);
+		
+		if (d < d1)
+		{
+			d2 = d1;
+			best = j, d1 = d;
+		}
+		else if (d < d2)
+			d2 = d;
+	}
+	
+	ctx->c->map[i] = best;
+	ctx->upper[i] = d1;
+	ctx->lower[i] = d2;
+}
+
+/**
+ * @brief Moves the sums of centroids after points changed centroids.
+ * 
+ * @details Points are gone through once, serially and in ascending order,
+ *          so each point is taken from its old centroid and added to the 
+ *          new one in O(d) time, whatever the number of centroids is, and
+ *          results do not depend on the number of threads.
+ * 
+ * @param ctx    Kmeans context.
+ * @param nmoved Number of points that changed centroids.
+ */
+static void kmeans_accumulate(struct kmeans_context *ctx, int nmoved)
+{
+	struct clustering *c = ctx->c;
+	int stride = c->points->stride;
+	
+	for (int m = 0; m < nmoved; m++)
+	{
+		int i = ctx->moved[m];
+		const float *x = clustering_point(c, i);
+		double *to = &ctx->sums[(size_t)c->map[i]*stride];
+		
+		/* Not assigned yet. */
+		if (ctx->from[i] >= 0)
+		{
+			double *from = &ctx->sums[(size_t)ctx->from[i]*stride];
+			
+			for (int l = 0; l < stride; l++)
+				from[l] -= x[l];
+			ctx->population[ctx->from[i]]--;
+		}
+		
+		for (int l = 0; l < stride; l++)
+			to[l] += x[l];
+		ctx->population[c->map[i]]++;
+	}
+}
+
+/**
+ * @brief Moves centroids to the mean of their points.
+ * 
+ * @details Empty clusters stay put. Bounds of points are then loosened by
+ *          how far centroids moved, and the distance from each centroid to
+ *          the closest other one is updated.
+ */
+static void kmeans_move(struct kmeans_context *ctx)
+{
+	int far;     /* Centroid that moved the most. */
+	double max1; /* Largest move.                 */
+	double max2; /* Second largest move.          */
+	struct clustering *c = ctx->c;
+	int k = c->ncentroids;
+	int stride = c->points->stride;
+	bool parallel = (c->npoints >= KMEANS_PARALLEL_MIN) && (!omp_in_parallel());
+	
+	#pragma omp parallel for schedule(static) if (parallel)
+	for (int j = 0; j < k; j++)
+	{
+		float *x = centroid(ctx, j);
+		float *old = features_row(ctx->previous, j);
+		const double *sum = &ctx->sums[(size_t)j*stride];
+		
+		ctx->shift[j] = 0.0;
+		if (ctx->population[j] > 0)
+		{
+			memcpy(old, x, stride*sizeof(float));
+			for (int l = 0; l < stride; l++)
+				x[l] = sum[l]/ctx->population[j];
+			ctx->shift[j] = features_distance(c->points, old, x);
+		}
+	}
+	
+	far = 0;
+	max1 = ctx->shift[0];
+	max2 = 0.0;
+	for (int j = 1; j < k; j++)
+	{
+		if (ctx->shift[j] > max1)
+		{
+			max2 = max1;
+			far = j, max1 = ctx->shift[j];
+		}
+		else if (ctx->shift[j] > max2)
+			max2 = ctx->shift[j];
+	}
+	
+	/* Loosen bounds. */
+	#pragma omp parallel for schedule(static) if (parallel)
+	for (int i = 0; i < c->npoints; i++)
+	{
+		ctx->upper[i] += ctx->shift[c->map[i]];
+		ctx->lower[i] -= (c->map[i] == far) ? max2 : max1;
+	}
+	
+	#pragma omp parallel for schedule(static) if (parallel)
+	for (int j = 0; j < k; j++)
+	{
+		double mindist = HUGE_VAL;
+		
+		for (int l = 0; l < k; l++)
+		{
+			double d;
+			
+			if (l == j)
+				continue;
+			
+			d = features_distance(c->points, centroid(ctx, j), centroid(ctx, l));
+			if (d < mindist)
+				mindist = d;
+		}
+		
+		ctx->half[j] = mindist/2;
+	}
+}
+
+/**
+ * @brief Lloyd's kmeans, accelerated with Hamerly's bounds.
+ * 
+ * @details Each point keeps an upper bound on the distance to its closest
+ *          centroid and a lower bound on the distance to the second closest
+ *          one. As long as the upper bound does not exceed the lower bound,
+ *          nor half the distance between its centroid and the closest other
+ *          one, a point cannot change centroid, and no distances are
+ *          computed for it at all. Sums of centroids are only updated for
+ *          points that changed centroid. Iterations run until no point
+ *          changes centroid.
+ * 
+ * @param ctx Kmeans context.
+ */
+static void kmeans_lloyd(struct kmeans_context *ctx)
+{
+	int nmoved; /* Points that changed centroid. */
+	struct clustering *c = ctx->c;
+	int n = c->npoints;
+	bool parallel = (n >= KMEANS_PARALLEL_MIN) && (!omp_in_parallel());
+	
+	/* Choose initial centroids. */
+	for (int i = 0; i < n; i++)
+		ctx->moved[i] = i;
+	kmeans_plusplus(ctx, ctx->moved, n);
+	
+	/* Assign points to closest centroids. */
+	#pragma omp parallel for schedule(static) if (parallel)
+	for (int i = 0; i < n; i++)
+	{
+		kmeans_scan(ctx, i);
+		ctx->from[i] = -1;
+	}
+	nmoved = n;
+	
+	for (int it = 0; it < KMEANS_MAX_ITERATIONS; it++)
+	{
+		kmeans_accumulate(ctx, nmoved);
+		kmeans_move(ctx);
+		
+		/* Reassign points whose bounds overlap. */
+		#pragma omp parallel for schedule(static) if (parallel)
+		for (int i = 0; i < n; i++)
+		{
+			int a = c->map[i];
+			double bound = (ctx->half[a] > ctx->lower[i]) ? ctx->half[a] : ctx->lower[i];
+			
+			ctx->from[i] = a;
+			
+			if (ctx->upper[i] <= bound)
+				continue;
+			
+			/* Tighten upper bound. */
+			ctx->upper[i] = distance(ctx, i, a);
+			if (ctx->upper[i] <= bound)
+				continue;
+			
+			kmeans_scan(ctx, i);
+		}
+		
+		nmoved = 0;
+		for (int i = 0; i < n; i++)
+		{
+			if (c->map[i] != ctx->from[i])
+				ctx->moved[nmoved++] = i;
+		}
+		
+		if (nmoved == 0)
+			break;
+	}
+}
+
+/**
+ * @brief Mini-batch kmeans.
+ * 
+ * @details Centroids are seeded with kmeans++ on a random sample, and then
+ *          moved towards the points of random mini-batches of @p batch
+ *          points, with a learning rate that decays as the inverse of the
+ *          number of points that each centroid has absorbed so far. Each
+ *          iteration thus only touches @p batch points, rather than the
+ *          whole data set. A final pass assigns every point to its closest
+ *          centroid.
+ * 
+ * @param ctx   Kmeans context.
+ * @param batch Number of points in a mini-batch.
+ */
+static void kmeans_minibatch(struct kmeans_context *ctx, int batch)
+{
+	int nsamples; /* Points used for seeding. */
+	int *ids;     /* Points of the batch.     */
+	int *nearest; /* Closest centroids.       */
+	struct clustering *c = ctx->c;
+	int n = c->npoints;
+	int stride = c->points->stride;
+	
+	nsamples = (batch > c->ncentroids) ? batch : c->ncentroids;
+	ids = smalloc(nsamples*sizeof(int));
+	nearest = smalloc(batch*sizeof(int));
+	
+	/* Choose initial centroids. */
+	for (int i = 0; i < nsamples; i++)
+		ids[i] = rand_next(ctx->stream)%n;
+	kmeans_plusplus(ctx, ids, nsamples);
+	
+	for (int it = 0; it < KMEANS_MAX_ITERATIONS; it++)
+	{
+		/* Draw a mini-batch. */
+		for (int i = 0; i < batch; i++)
+			ids[i] = rand_next(ctx->stream)%n;
+		
+		/* Assign points to closest centroids. */
+		#pragma omp parallel for schedule(static) if ((batch >= KMEANS_PARALLEL_MIN) && (!omp_in_parallel()))
+		for (int i = 0; i < batch; i++)
+			nearest[i] = kmeans_nearest(ctx, ids[i]);
+		
+		/* Move centroids towards their points. */
+		for (int i = 0; i < batch; i++)
+		{
+			int j = nearest[i];
+			float *x = centroid(ctx, j);
+			const float *y = clustering_point(c, ids[i]);
+			float rate = 1.0f/++ctx->population[j];
+			
+			for (int l = 0; l < stride; l++)
+				x[l] += rate*(y[l] - x[l]);
+		}
+	}
+	
+	/* Assign all points to closest centroids. */
+	#pragma omp parallel for schedule(static) if ((n >= KMEANS_PARALLEL_MIN) && (!omp_in_parallel()))
+	for (int i = 0; i < n; i++)
+		c->map[i] = kmeans_nearest(ctx, i);
+	
+	/* House keeping. */
+	free(nearest);
+	free(ids);
+}
+
+/**
+ * @brief Kmeans clustering.
+ * 
+ * @details Unlike kmeans() from mylib, which keeps its state in globals and
+ *          draws from the global random stream, all the state of a
+ *          clustering lives in its own context, and only @p stream is drawn
+ *          from, so that clusterings may go on concurrently. Large problems
+ *          outside of parallel regions compute distances in parallel, and
+ *          results do not depend on the number of threads.
+ * 
+ * @param points     Data points.
+ * @param ids        Points that shall be clustered (NULL for all).
+ * @param npoints    Number of points that shall be clustered.
+ * @param ncentroids Number of centroids.
+ * @param batch      Mini-batch size (0 for full batches).
+ * @param stream     Private random stream.
+ * 
+ * @returns A clustering.
+ */
+struct clustering *kmeans_cluster
+(const struct features *points, const int *ids, int npoints, int ncentroids, int batch, unsigned *stream)
+{
+	struct kmeans_context *ctx; /* Kmeans context. */
+	
+	/* Sanity check. */
+	assert(points != NULL);
+	assert(npoints > 0);
+	assert(ncentroids > 0);
+	assert(batch >= 0);
+	assert(stream != NULL);
+	
+	ctx = kmeans_context_create(points, ids, npoints, ncentroids, stream);
+	
+	if ((batch > 0) && (npoints > batch))
+		kmeans_minibatch(ctx, batch);
+	else
+		kmeans_lloyd(ctx);
+	
+	return (kmeans_context_destroy(ctx));
+}
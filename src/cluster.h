@@ -0,0 +1,111 @@
+/*
+ * Copyright(C) 2015 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Mapper.
+ *
+ * Mapper is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Mapper is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MyLib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CLUSTER_H_
+#define CLUSTER_H_
+
+	#include <math.h>
+	#include <stddef.h>
+
+	/**
+	 * @brief Block of features.
+	 *
+	 * @details Points are stored as contiguous rows of floats, each one
+	 *          aligned to and padded up to 64 bytes with zeros.
+	 */
+	struct features
+	{
+		int npoints;                                        /**< Number of points.         */
+		int dimension;                                      /**< Dimension of points.      */
+		int stride;                                         /**< Floats from row to row.   */
+		float *data;                                        /**< Rows.                     */
+		float (*kernel)(const float *, const float *, int); /**< Squared distance kernel. */
+	};
+
+	/**
+	 * @brief Returns a row of a block of features.
+	 */
+	static inline float *features_row(const struct features *f, int i)
+	{
+		return (&f->data[(size_t)i*f->stride]);
+	}
+
+	/**
+	 * @brief Returns the distance between two rows of a block of features.
+	 */
+	static inline double features_distance(const struct features *f, const float *a, const float *b)
+	{
+		return (sqrt(f->kernel(a, b, f->stride)));
+	}
+
+	/**
+	 * @brief Clustering of points.
+	 */
+	struct clustering
+	{
+		int npoints;                   /**< Number of points.                  */
+		int ncentroids;                /**< Number of centroids.               */
+		const struct features *points; /**< Data points.                       */
+		const int *ids;                /**< Clustered points (NULL for all).   */
+		struct features *centroids;    /**< Centroids.                         */
+		int *map;                      /**< Cluster of each point.             */
+	};
+
+	/**
+	 * @brief Returns a point of a clustering.
+	 */
+	static inline const float *clustering_point(const struct clustering *c, int i)
+	{
+		return (features_row(c->points, (c->ids != NULL) ? c->ids[i] : i));
+	}
+
+	/**
+	 * @brief Minimum number of points for data-parallel kmeans.
+	 */
+	#define KMEANS_PARALLEL_MIN 256
+
+	/**
+	 * @brief Returns the next number of a private random stream.
+	 */
+	static inline unsigned rand_next(unsigned *state)
+	{
+		unsigned x = *state;
+		
+		x ^= x << 13;
+		x ^= x >> 17;
+		x ^= x << 5;
+		
+		return (*state = x);
+	}
+
+	/**
+	 * @brief Returns a uniform random number in [0, 1).
+	 */
+	static inline double rand_uniform(unsigned *state)
+	{
+		return (rand_next(state)/4294967296.0);
+	}
+
+	/* Forward definitions. */
+	extern struct features *features_create(int, int);
+	extern void features_destroy(struct features *);
+	extern struct clustering *kmeans_cluster(const struct features *, const int *, int, int, int, unsigned *);
+	extern void clustering_destroy(struct clustering *);
+
+#endif /* CLUSTER_H_ */
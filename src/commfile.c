@@ -0,0 +1,237 @@
+/*
+ * Copyright(C) 2015 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Mapper.
+ *
+ * Mapper is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Mapper is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MyLib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <assert.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <mylib/util.h>
+
+#include "commfile.h"
+#include "mapper.h"
+
+/**
+ * @brief Computes the offset of the weights array in a binary file.
+ *
+ * @param nprocs Number of processes.
+ * @param nedges Number of edges.
+ *
+ * @returns The offset of the weights array.
+ */
+static size_t commfile_weights_offset(size_t nprocs, size_t nedges)
+{
+	size_t offset;
+
+	offset = sizeof(struct commfile_header);
+	offset += (nprocs + 1)*sizeof(int32_t);
+	offset += nedges*sizeof(int32_t);
+
+	return ((offset + sizeof(double) - 1) & ~(sizeof(double) - 1));
+}
+
+/**
+ * @brief Asserts if a file is a binary communication file.
+ *
+ * @param file Target file.
+ *
+ * @returns True if the file is a binary communication file, and false
+ *          otherwise.
+ */
+bool commfile_check(FILE *file)
+{
+	char magic[4];
+	bool ret;
+	struct stat st;
+
+	/* Sanity check. */
+	assert(file != NULL);
+
+	/* Binary files must be mapped. */
+	if ((fstat(fileno(file), &st) < 0) || (!S_ISREG(st.st_mode)))
+		return (false);
+
+	ret = ((fread(magic, 1, sizeof(magic), file) == sizeof(magic)) &&
+	       (!memcmp(magic, COMMFILE_MAGIC, sizeof(magic))));
+
+	fseek(file, 0, SEEK_SET);
+
+	return (ret);
+}
+
+/**
+ * @brief Loads a binary communication file.
+ *
+ * @details Maps the binary communication file @p file in memory and builds a
+ *          communication graph on top of it, so no parsing takes place. Files
+ *          that do not store both edge directions are symmetrized, whereas
+ *          files that claim to must have sorted and symmetric adjacency
+ *          lists, which is checked in O(E log d).
+ *
+ * @param file Target file.
+ *
+ * @returns A communication graph.
+ */
+struct graph *commfile_load(FILE *file)
+{
+	struct stat st;                  /* File status.         */
+	void *base;                      /* File mapping.        */
+	size_t size;                     /* File size.           */
+	size_t nprocs;                   /* Number of processes. */
+	size_t nedges;                   /* Number of edges.     */
+	struct graph *g;                 /* Communication graph. */
+	const struct commfile_header *h; /* File header.         */
+
+	/* Sanity check. */
+	assert(file != NULL);
+
+	if (fstat(fileno(file), &st) < 0)
+		error("cannot stat communication file");
+	size = st.st_size;
+	if (size < sizeof(struct commfile_header))
+		error("bad communication file");
+
+	base = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fileno(file), 0);
+	if (base == MAP_FAILED)
+		error("cannot map communication file");
+
+	/* Check header. */
+	h = base;
+	if (memcmp(h->magic, COMMFILE_MAGIC, sizeof(h->magic)))
+		error("bad communication file");
+	if (h->version != COMMFILE_VERSION)
+		error("unsupported communication file version %u", h->version);
+	nprocs = h->nprocs;
+	nedges = h->nedges;
+	if ((nprocs == 0) || (nprocs >= INT_MAX) || (nedges >= INT_MAX))
+		error("bad communication file");
+	if (size < commfile_weights_offset(nprocs, nedges) + nedges*sizeof(double))
+		error("truncated communication file");
+
+	g = smalloc(sizeof(struct graph));
+	g->nvertices = nprocs;
+	g->nedges = nedges;
+	g->offsets = (int *)((char *)base + sizeof(struct commfile_header));
+	g->adjacency = g->offsets + nprocs + 1;
+	g->weights = (double *)((char *)base + commfile_weights_offset(nprocs, nedges));
+	g->base = base;
+	g->size = size;
+
+	/* Check adjacency lists. */
+	if ((g->offsets[0] != 0) || ((size_t)g->offsets[nprocs] != nedges))
+		error("bad communication file");
+	for (size_t i = 0; i < nprocs; i++)
+	{
+		if (g->offsets[i] > g->offsets[i + 1])
+			error("bad communication file");
+	}
+	for (size_t i = 0; i < nprocs; i++)
+	{
+		for (int k = g->offsets[i]; k < g->offsets[i + 1]; k++)
+		{
+			if ((g->adjacency[k] < 0) || ((size_t)g->adjacency[k] >= nprocs))
+				error("bad communication file");
+			
+			/* Symmetric lists are binary searched. */
+			if ((h->flags & COMMFILE_SYMMETRIC) && (k > g->offsets[i]) && (g->adjacency[k - 1] >= g->adjacency[k]))
+				error("unsorted communication file");
+		}
+	}
+	
+	/* Check symmetry. */
+	if (h->flags & COMMFILE_SYMMETRIC)
+	{
+		for (size_t i = 0; i < nprocs; i++)
+		{
+			for (int k = g->offsets[i]; k < g->offsets[i + 1]; k++)
+			{
+				if (graph_get(g, g->adjacency[k], i) != g->weights[k])
+					error("asymmetric communication file");
+			}
+		}
+	}
+
+	/* Symmetrize graph. */
+	if (!(h->flags & COMMFILE_SYMMETRIC))
+	{
+		struct graph *sym;  /* Symmetric graph.       */
+		struct edge *edges; /* Communication records. */
+
+		edges = smalloc((nedges + 1)*sizeof(struct edge));
+		for (size_t i = 0; i < nprocs; i++)
+		{
+			for (int k = g->offsets[i]; k < g->offsets[i + 1]; k++)
+			{
+				edges[k].src = i;
+				edges[k].dest = g->adjacency[k];
+				edges[k].cost = g->weights[k];
+			}
+		}
+
+		sym = graph_create(nprocs, edges, nedges);
+
+		/* House keeping. */
+		free(edges);
+		graph_destroy(g);
+
+		g = sym;
+	}
+
+	return (g);
+}
+
+/**
+ * @brief Stores a communication graph in a binary communication file.
+ *
+ * @param g    Communication graph.
+ * @param file Target file.
+ */
+void commfile_store(const struct graph *g, FILE *file)
+{
+	size_t padding;                 /* Padding size.  */
+	struct commfile_header h;       /* File header.   */
+	static const char pad[8] = {0}; /* Padding bytes. */
+
+	/* Sanity check. */
+	assert(g != NULL);
+	assert(file != NULL);
+
+	/* Build header. */
+	memcpy(h.magic, COMMFILE_MAGIC, sizeof(h.magic));
+	h.version = COMMFILE_VERSION;
+	h.nprocs = g->nvertices;
+	h.flags = COMMFILE_SYMMETRIC;
+	h.nedges = g->nedges;
+
+	padding = commfile_weights_offset(g->nvertices, g->nedges)
+	        - sizeof(struct commfile_header)
+	        - (g->nvertices + 1 + g->nedges)*sizeof(int32_t);
+
+	/* Write graph. */
+	if ((fwrite(&h, sizeof(h), 1, file) != 1) ||
+	    (fwrite(g->offsets, sizeof(int32_t), g->nvertices + 1, file) != (size_t)g->nvertices + 1) ||
+	    (fwrite(g->adjacency, sizeof(int32_t), g->nedges, file) != (size_t)g->nedges) ||
+	    (fwrite(pad, 1, padding, file) != padding) ||
+	    (fwrite(g->weights, sizeof(double), g->nedges, file) != (size_t)g->nedges))
+		error("cannot write communication file");
+}
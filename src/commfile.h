@@ -0,0 +1,68 @@
+/*
+ * Copyright(C) 2015 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Mapper.
+ *
+ * Mapper is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Mapper is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MyLib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COMMFILE_H_
+#define COMMFILE_H_
+
+	#include <stdbool.h>
+	#include <stdint.h>
+	#include <stdio.h>
+
+	#include "mapper.h"
+
+	/**
+	 * @brief Binary communication file magic number.
+	 */
+	#define COMMFILE_MAGIC "MCSR"
+
+	/**
+	 * @brief Binary communication file version.
+	 */
+	#define COMMFILE_VERSION 1
+
+	/**
+	 * @brief Binary communication file flags.
+	 */
+	/**@{*/
+	#define COMMFILE_SYMMETRIC (1 << 0) /**< Both edge directions stored? */
+	/**@}*/
+
+	/**
+	 * @brief Binary communication file header.
+	 *
+	 * @details The header is followed by the compressed sparse row arrays of
+	 *          the communication graph, in host byte order: nprocs + 1 int32
+	 *          offsets, nedges int32 adjacencies and, starting at the next
+	 *          8-byte boundary, nedges double weights.
+	 */
+	struct commfile_header
+	{
+		char magic[4];    /**< Magic number.        */
+		uint32_t version; /**< Format version.      */
+		uint32_t nprocs;  /**< Number of processes. */
+		uint32_t flags;   /**< Flags.               */
+		uint64_t nedges;  /**< Number of edges.     */
+	};
+
+	/* Forward definitions. */
+	extern bool commfile_check(FILE *);
+	extern struct graph *commfile_load(FILE *);
+	extern void commfile_store(const struct graph *, FILE *);
+
+#endif /* COMMFILE_H_ */
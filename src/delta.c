@@ -0,0 +1,375 @@
+/*
+ * Copyright(C) 2015 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Mapper.
+ *
+ * Mapper is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Mapper is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MyLib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <mylib/util.h>
+
+#include "mapper.h"
+
+/**
+ * @brief Journaled operation.
+ */
+struct operation
+{
+	int a; /**< Moved process.                           */
+	int b; /**< Swapped process or -1.                   */
+	int c; /**< Previous core of process a (moves only). */
+};
+
+/**
+ * @brief Incremental map evaluator.
+ */
+struct delta
+{
+	const struct graph *traffic;  /**< Communication graph.            */
+	const struct processor *proc; /**< Processor's topology.           */
+	int *map;                     /**< Process map.                    */
+	int *owner;                   /**< Process on each core (or -1).   */
+	double cost;                  /**< Current cost (hop-bytes).       */
+	struct operation *journal;    /**< Uncommitted operations.         */
+	int njournal;                 /**< Number of journaled operations. */
+	int maxjournal;               /**< Capacity of journal.            */
+};
+
+/**
+ * @brief Computes the cost contribution of a process.
+ *
+ * @param d Incremental map evaluator.
+ * @param a Target process.
+ *
+ * @returns The cost contribution of process @p a.
+ */
+static double contribution(const struct delta *d, int a)
+{
+	double sum;
+	const struct graph *g = d->traffic;
+
+	sum = 0.0;
+	for (int k = g->offsets[a]; k < g->offsets[a + 1]; k++)
+	{
+		int j = g->adjacency[k];
+
+		if (j != a)
+			sum += g->weights[k]*processor_distance(d->proc, d->map[a], d->map[j]);
+	}
+
+	return (sum);
+}
+
+/**
+ * @brief Journals an operation.
+ */
+static void journal(struct delta *d, int a, int b, int c)
+{
+	/* Grow journal. */
+	if (d->njournal == d->maxjournal)
+	{
+		d->maxjournal *= 2;
+		d->journal = srealloc(d->journal, d->maxjournal*sizeof(struct operation));
+	}
+
+	d->journal[d->njournal].a = a;
+	d->journal[d->njournal].b = b;
+	d->journal[d->njournal].c = c;
+	d->njournal++;
+}
+
+/**
+ * @brief Creates an incremental map evaluator.
+ *
+ * @param traffic Communication graph.
+ * @param proc    Processor's topology.
+ * @param map     Initial process map.
+ *
+ * @returns An incremental map evaluator.
+ */
+struct delta *delta_create
+(const struct graph *traffic, const struct processor *proc, const int *map)
+{
+	struct delta *d;
+
+	/* Sanity check. */
+	assert(traffic != NULL);
+	assert(proc != NULL);
+	assert(map != NULL);
+
+	d = smalloc(sizeof(struct delta));
+	d->traffic = traffic;
+	d->proc = proc;
+	d->map = smalloc(traffic->nvertices*sizeof(int));
+	d->owner = smalloc(proc->ncores*sizeof(int));
+	d->maxjournal = 64;
+	d->njournal = 0;
+	d->journal = smalloc(d->maxjournal*sizeof(struct operation));
+
+	memcpy(d->map, map, traffic->nvertices*sizeof(int));
+	for (int i = 0; i < proc->ncores; i++)
+		d->owner[i] = -1;
+	for (int i = 0; i < traffic->nvertices; i++)
+		d->owner[map[i]] = i;
+
+	/* Compute cost. */
+	d->cost = 0.0;
+	for (int i = 0; i < traffic->nvertices; i++)
+		d->cost += contribution(d, i);
+	d->cost /= 2;
+
+	return (d);
+}
+
+/**
+ * @brief Destroys an incremental map evaluator.
+ *
+ * @param d Target incremental map evaluator.
+ */
+void delta_destroy(struct delta *d)
+{
+	/* Sanity check. */
+	assert(d != NULL);
+
+	free(d->journal);
+	free(d->owner);
+	free(d->map);
+	free(d);
+}
+
+/**
+ * @brief Returns the current cost (hop-bytes) of a process map.
+ */
+double delta_cost(const struct delta *d)
+{
+	return (d->cost);
+}
+
+/**
+ * @brief Returns the current process map.
+ */
+const int *delta_map(const struct delta *d)
+{
+	return (d->map);
+}
+
+/**
+ * @brief Returns the process that is mapped on a core.
+ *
+ * @returns The process that is mapped on core @p c, or -1 if the core is free.
+ */
+int delta_owner(const struct delta *d, int c)
+{
+	return (d->owner[c]);
+}
+
+/**
+ * @brief Computes the cost delta of swapping the cores of two processes.
+ *
+ * @details The cost of the query is O(deg(a) + deg(b)).
+ *
+ * @param d Incremental map evaluator.
+ * @param a First process.
+ * @param b Second process.
+ *
+ * @returns The cost variation if processes @p a and @p b swap cores.
+ */
+double delta_swap(const struct delta *d, int a, int b)
+{
+	int ca, cb;
+	double delta;
+	const struct graph *g = d->traffic;
+
+	/* Sanity check. */
+	assert((a >= 0) && (a < g->nvertices));
+	assert((b >= 0) && (b < g->nvertices));
+
+	ca = d->map[a];
+	cb = d->map[b];
+
+	delta = 0.0;
+	for (int k = g->offsets[a]; k < g->offsets[a + 1]; k++)
+	{
+		int j = g->adjacency[k];
+
+		if ((j != a) && (j != b))
+			delta += g->weights[k]*(processor_distance(d->proc, cb, d->map[j]) - processor_distance(d->proc, ca, d->map[j]));
+	}
+	for (int k = g->offsets[b]; k < g->offsets[b + 1]; k++)
+	{
+		int j = g->adjacency[k];
+
+		if ((j != a) && (j != b))
+			delta += g->weights[k]*(processor_distance(d->proc, ca, d->map[j]) - processor_distance(d->proc, cb, d->map[j]));
+	}
+
+	return (delta);
+}
+
+/**
+ * @brief Computes the cost delta of moving a process to a free core.
+ *
+ * @details The cost of the query is O(deg(a)).
+ *
+ * @param d Incremental map evaluator.
+ * @param a Target process.
+ * @param c Target core.
+ *
+ * @returns The cost variation if process @p a moves to core @p c.
+ */
+double delta_move(const struct delta *d, int a, int c)
+{
+	int ca;
+	double delta;
+	const struct graph *g = d->traffic;
+
+	/* Sanity check. */
+	assert((a >= 0) && (a < g->nvertices));
+	assert((c >= 0) && (c < d->proc->ncores));
+	assert(d->owner[c] < 0);
+
+	ca = d->map[a];
+
+	delta = 0.0;
+	for (int k = g->offsets[a]; k < g->offsets[a + 1]; k++)
+	{
+		int j = g->adjacency[k];
+
+		if (j != a)
+			delta += g->weights[k]*(processor_distance(d->proc, c, d->map[j]) - processor_distance(d->proc, ca, d->map[j]));
+	}
+
+	return (delta);
+}
+
+/**
+ * @brief Swaps the cores of two processes.
+ *
+ * @param d Incremental map evaluator.
+ * @param a First process.
+ * @param b Second process.
+ */
+static void swap(struct delta *d, int a, int b)
+{
+	int ca, cb;
+
+	ca = d->map[a];
+	cb = d->map[b];
+
+	d->cost += delta_swap(d, a, b);
+
+	d->map[a] = cb;
+	d->map[b] = ca;
+	d->owner[cb] = a;
+	d->owner[ca] = b;
+}
+
+/**
+ * @brief Moves a process to a free core.
+ *
+ * @param d Incremental map evaluator.
+ * @param a Target process.
+ * @param c Target core.
+ */
+static void move(struct delta *d, int a, int c)
+{
+	int ca;
+
+	ca = d->map[a];
+
+	d->cost += delta_move(d, a, c);
+
+	d->map[a] = c;
+	d->owner[ca] = -1;
+	d->owner[c] = a;
+}
+
+/**
+ * @brief Swaps the cores of two processes.
+ *
+ * @details The operation is journaled until delta_commit() is called.
+ *
+ * @param d Incremental map evaluator.
+ * @param a First process.
+ * @param b Second process.
+ */
+void delta_apply_swap(struct delta *d, int a, int b)
+{
+	/* Sanity check. */
+	assert(d != NULL);
+	assert(a != b);
+
+	swap(d, a, b);
+	journal(d, a, b, -1);
+}
+
+/**
+ * @brief Moves a process to a free core.
+ *
+ * @details The operation is journaled until delta_commit() is called.
+ *
+ * @param d Incremental map evaluator.
+ * @param a Target process.
+ * @param c Target core.
+ */
+void delta_apply_move(struct delta *d, int a, int c)
+{
+	int ca;
+
+	/* Sanity check. */
+	assert(d != NULL);
+
+	ca = d->map[a];
+	move(d, a, c);
+	journal(d, a, -1, ca);
+}
+
+/**
+ * @brief Commits all journaled operations.
+ *
+ * @param d Incremental map evaluator.
+ */
+void delta_commit(struct delta *d)
+{
+	/* Sanity check. */
+	assert(d != NULL);
+
+	d->njournal = 0;
+}
+
+/**
+ * @brief Undoes all journaled operations.
+ *
+ * @param d Incremental map evaluator.
+ */
+void delta_rollback(struct delta *d)
+{
+	/* Sanity check. */
+	assert(d != NULL);
+
+	/* Undo operations in reverse order. */
+	while (d->njournal > 0)
+	{
+		struct operation *op = &d->journal[--d->njournal];
+
+		if (op->b >= 0)
+			swap(d, op->a, op->b);
+		else
+			move(d, op->a, op->c);
+	}
+}
@@ -0,0 +1,582 @@
+/*
+ * Copyright(C) 2015 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Mapper.
+ *
+ * Mapper is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Mapper is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MyLib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <assert.h>
+#include <limits.h>
+#include <math.h>
+#include <omp.h>
+#include <stdlib.h>
+
+#include <mylib/util.h>
+
+#include "mapper.h"
+
+/**
+ * @brief Sums hop-bytes with a closed-form distance oracle.
+ *
+ * @details Core locations of processes are gathered up front, along with
+ *          their chips, so the inner loop is free of divisions and of
+ *          branches on the oracle, and vectorizes. Mesh, torus and board
+ *          distances only differ in ring lengths and chip locations, which
+ *          are set so that the same expression answers all of them.
+ *
+ * @param traffic     Communication graph.
+ * @param proc        Processor's topology.
+ * @param map         Process map.
+ * @param hopbytes    Hop-bytes, both directions accounted (output).
+ * @param volume      Communication volume (output).
+ * @param maxdistance Longest distance (output).
+ */
+static void evaluate_closed
+(const struct graph *traffic, const struct processor *proc, const int *map,
+ double *hopbytes, double *volume, int *maxdistance)
+{
+	int nprocs;          /* Number of processes.    */
+	int *loc[NR_AXES];   /* Process locations.      */
+	int *chip[2];        /* Process chips.          */
+	int ring[NR_AXES];   /* Ring lengths.           */
+	int weight[NR_AXES]; /* Cost of links.          */
+	int cost;            /* Cost of off-chip links. */
+	double hb;           /* Hop-bytes.              */
+	double vol;          /* Communication volume.   */
+	int maxd;            /* Longest distance.       */
+
+	nprocs = traffic->nvertices;
+
+	/* Ring lengths, large enough to never wrap in a mesh. */
+	for (int a = 0; a < NR_AXES; a++)
+	{
+		ring[a] = INT_MAX/2;
+		weight[a] = proc->axisweights[a];
+	}
+	if (proc->oracle == DISTANCE_TORUS)
+	{
+		ring[AXIS_X] = proc->width;
+		ring[AXIS_Y] = proc->height;
+		ring[AXIS_Z] = proc->depth;
+	}
+	cost = (proc->oracle == DISTANCE_CHIPS) ? proc->chips.cost : 0;
+
+	/* Gather process locations. */
+	for (int a = 0; a < NR_AXES; a++)
+		loc[a] = smalloc(nprocs*sizeof(int));
+	chip[0] = scalloc(nprocs, sizeof(int));
+	chip[1] = scalloc(nprocs, sizeof(int));
+	for (int i = 0; i < nprocs; i++)
+	{
+		loc[AXIS_X][i] = proc->x[map[i]];
+		loc[AXIS_Y][i] = proc->y[map[i]];
+		loc[AXIS_Z][i] = proc->z[map[i]];
+		if (proc->oracle == DISTANCE_CHIPS)
+		{
+			chip[0][i] = proc->x[map[i]]/proc->chips.width;
+			chip[1][i] = proc->y[map[i]]/proc->chips.height;
+		}
+	}
+
+	hb = 0.0;
+	vol = 0.0;
+	maxd = 0;
+
+	#pragma omp parallel for schedule(dynamic, 64) \
+		reduction(+:hb, vol) reduction(max:maxd)
+	for (int i = 0; i < nprocs; i++)
+	{
+		const int begin = traffic->offsets[i];
+		const int end = traffic->offsets[i + 1];
+		const int *restrict adjacency = traffic->adjacency;
+		const double *restrict weights = traffic->weights;
+		const int *restrict x = loc[AXIS_X];
+		const int *restrict y = loc[AXIS_Y];
+		const int *restrict z = loc[AXIS_Z];
+		const int *restrict cx = chip[0];
+		const int *restrict cy = chip[1];
+
+		#pragma omp simd reduction(+:hb, vol) reduction(max:maxd)
+		for (int k = begin; k < end; k++)
+		{
+			int j;
+			int dx, dy, dz;
+			int crx, cry;
+			int distance;
+			double w;
+
+			j = adjacency[k];
+			w = (j != i) ? weights[k] : 0.0;
+
+			dx = abs(x[i] - x[j]);
+			dy = abs(y[i] - y[j]);
+			dz = abs(z[i] - z[j]);
+			dx = (dx < ring[AXIS_X] - dx) ? dx : ring[AXIS_X] - dx;
+			dy = (dy < ring[AXIS_Y] - dy) ? dy : ring[AXIS_Y] - dy;
+			dz = (dz < ring[AXIS_Z] - dz) ? dz : ring[AXIS_Z] - dz;
+			crx = abs(cx[i] - cx[j]);
+			cry = abs(cy[i] - cy[j]);
+
+			distance = weight[AXIS_X]*(dx - crx) + weight[AXIS_Y]*(dy - cry) +
+			           weight[AXIS_Z]*dz + cost*(crx + cry);
+
+			hb += distance*w;
+			vol += w;
+			if ((w > 0.0) && (distance > maxd))
+				maxd = distance;
+		}
+	}
+
+	*hopbytes = hb;
+	*volume = vol;
+	*maxdistance = maxd;
+
+	/* House keeping. */
+	free(chip[1]);
+	free(chip[0]);
+	for (int a = 0; a < NR_AXES; a++)
+		free(loc[a]);
+}
+
+/**
+ * @brief Sums hop-bytes with an all-pairs distance table.
+ *
+ * @details Each process looks up its own row of the table, which is picked
+ *          once per process, so the inner loop only gathers entries.
+ *
+ * @param traffic     Communication graph.
+ * @param proc        Processor's topology.
+ * @param map         Process map.
+ * @param hopbytes    Hop-bytes, both directions accounted (output).
+ * @param volume      Communication volume (output).
+ * @param maxdistance Longest distance (output).
+ */
+static void evaluate_table
+(const struct graph *traffic, const struct processor *proc, const int *map,
+ double *hopbytes, double *volume, int *maxdistance)
+{
+	int nprocs; /* Number of processes.  */
+	double hb;  /* Hop-bytes.            */
+	double vol; /* Communication volume. */
+	int maxd;   /* Longest distance.     */
+
+	nprocs = traffic->nvertices;
+
+	hb = 0.0;
+	vol = 0.0;
+	maxd = 0;
+
+	#pragma omp parallel for schedule(dynamic, 64) \
+		reduction(+:hb, vol) reduction(max:maxd)
+	for (int i = 0; i < nprocs; i++)
+	{
+		const int begin = traffic->offsets[i];
+		const int end = traffic->offsets[i + 1];
+		const int *restrict adjacency = traffic->adjacency;
+		const double *restrict weights = traffic->weights;
+		const size_t row = (size_t)map[i]*proc->ncores;
+
+		if (proc->oracle == DISTANCE_TABLE8)
+		{
+			const uint8_t *restrict t = (const uint8_t *)proc->table + row;
+
+			#pragma omp simd reduction(+:hb, vol) reduction(max:maxd)
+			for (int k = begin; k < end; k++)
+			{
+				int j = adjacency[k];
+				int distance = t[map[j]];
+				double w = (j != i) ? weights[k] : 0.0;
+
+				hb += distance*w;
+				vol += w;
+				if ((w > 0.0) && (distance > maxd))
+					maxd = distance;
+			}
+		}
+		else
+		{
+			const uint16_t *restrict t = (const uint16_t *)proc->table + row;
+
+			#pragma omp simd reduction(+:hb, vol) reduction(max:maxd)
+			for (int k = begin; k < end; k++)
+			{
+				int j = adjacency[k];
+				int distance = t[map[j]];
+				double w = (j != i) ? weights[k] : 0.0;
+
+				hb += distance*w;
+				vol += w;
+				if ((w > 0.0) && (distance > maxd))
+					maxd = distance;
+			}
+		}
+	}
+
+	*hopbytes = hb;
+	*volume = vol;
+	*maxdistance = maxd;
+}
+
+/**
+ * @brief Evaluates how good a process map is.
+ *
+ * @details Walks through every communicating pair of processes in @p traffic
+ *          and computes the hop-bytes, the longest distance and the average
+ *          distance weighted by communication volume of the process map
+ *          @p map. The distance oracle of the processor is dispatched once,
+ *          to a loop that is specialized for it.
+ *
+ * @param traffic Communication graph.
+ * @param proc    Processor's topology.
+ * @param map     Process map.
+ * @param eval    Process map evaluation (output).
+ */
+void evaluate
+(const struct graph *traffic, const struct processor *proc, const int *map, struct evaluation *eval)
+{
+	double hopbytes; /* Hop-bytes.            */
+	double volume;   /* Communication volume. */
+	int maxdistance; /* Longest distance.     */
+
+	/* Sanity check. */
+	assert(traffic != NULL);
+	assert(proc != NULL);
+	assert(map != NULL);
+	assert(eval != NULL);
+
+	switch (proc->oracle)
+	{
+		case DISTANCE_TABLE8:
+		case DISTANCE_TABLE16:
+			evaluate_table(traffic, proc, map, &hopbytes, &volume, &maxdistance);
+			break;
+		default:
+			evaluate_closed(traffic, proc, map, &hopbytes, &volume, &maxdistance);
+			break;
+	}
+
+	/* Both directions of each pair were accounted. */
+	eval->hopbytes = hopbytes/2;
+	eval->maxdistance = maxdistance;
+	eval->avgdistance = (volume > 0.0) ? hopbytes/volume : 0.0;
+}
+
+/**
+ * @brief Asserts if a link exists.
+ *
+ * @param proc Processor's topology.
+ * @param c    Core.
+ * @param dir  Link direction.
+ *
+ * @returns True if core @p c has an outgoing link in direction @p dir, and
+ *          false otherwise.
+ */
+static bool link_exists(const struct processor *proc, int c, int dir)
+{
+	switch (dir)
+	{
+		case LINK_EAST:
+			return ((proc->torus && proc->width > 2) || (proc->x[c] < proc->width - 1));
+		case LINK_WEST:
+			return ((proc->torus && proc->width > 2) || (proc->x[c] > 0));
+		case LINK_NORTH:
+			return ((proc->torus && proc->height > 2) || (proc->y[c] > 0));
+		case LINK_SOUTH:
+			return ((proc->torus && proc->height > 2) || (proc->y[c] < proc->height - 1));
+		case LINK_UP:
+			return ((proc->torus && proc->depth > 2) || (proc->z[c] < proc->depth - 1));
+		default:
+			return ((proc->torus && proc->depth > 2) || (proc->z[c] > 0));
+	}
+}
+
+/**
+ * @brief Computes the shortest route along a line or ring.
+ *
+ * @param from Source location.
+ * @param to   Target location.
+ * @param n    Number of locations.
+ * @param wrap Ring?
+ * @param dir  Route direction, +1 or -1 (output).
+ *
+ * @returns The number of links in the route.
+ */
+static inline int hops(int from, int to, int n, bool wrap, int *dir)
+{
+	int forward;
+
+	if (!wrap)
+	{
+		*dir = (to > from) ? 1 : -1;
+		return (abs(to - from));
+	}
+
+	/* Ties go forward. */
+	forward = (to - from + n)%n;
+	if (forward <= n - forward)
+	{
+		*dir = 1;
+		return (forward);
+	}
+
+	*dir = -1;
+	return (n - forward);
+}
+
+/**
+ * @brief Adds load to consecutive links of a line or ring.
+ *
+ * @param diff Difference array of the line, with n + 1 entries.
+ * @param n    Number of locations.
+ * @param lo   First link.
+ * @param len  Number of links.
+ * @param w    Load.
+ */
+static inline void span(double *diff, int n, int lo, int len, double w)
+{
+	if (lo < 0)
+		lo += n;
+
+	diff[lo] += w;
+
+	/* Wrap around. */
+	if (lo + len > n)
+	{
+		diff[n] -= w;
+		diff[0] += w;
+		diff[lo + len - n] -= w;
+	}
+	else
+		diff[lo + len] -= w;
+}
+
+/**
+ * @brief Prefix sums lines of difference arrays in place.
+ *
+ * @param diff   Difference arrays.
+ * @param nlines Number of lines.
+ * @param n      Number of locations in a line, which holds n + 1 entries.
+ */
+static void prefix(double *diff, long nlines, int n)
+{
+	for (long l = 0; l < nlines; l++)
+	{
+		double *line = &diff[l*(n + 1)];
+
+		for (int t = 1; t < n; t++)
+			line[t] += line[t - 1];
+	}
+}
+
+/**
+ * @brief Evaluates link loads of a process map.
+ *
+ * @details Routes every communicating pair of processes with dimension-ordered
+ *          (XYZ) routing and accumulates traffic on each directed link. In a
+ *          torus, each dimension takes the shortest way around. Since the
+ *          communication graph is symmetric, the volume between each pair is
+ *          split evenly between both directions. Routes are accumulated as
+ *          difference arrays along rows, columns and pillars, which are then
+ *          prefix summed, so the cost is O(E + ncores) instead of
+ *          O(E * distance).
+ *
+ * @param traffic Communication graph.
+ * @param proc    Processor's topology.
+ * @param map     Process map.
+ * @param ll      Link load evaluation (output).
+ */
+void evaluate_links
+(const struct graph *traffic, const struct processor *proc, const int *map, struct linkload *ll)
+{
+	int W, H, D;              /* Mesh dimensions.           */
+	bool wrapx, wrapy, wrapz; /* Wraparound links?          */
+	long rows, cols, pillars; /* Size of difference arrays. */
+	long size;                /* Size of difference arrays. */
+	int nthreads;             /* Number of threads.         */
+	double *diff;             /* Difference arrays.         */
+	int *x, *y, *z;           /* Process locations.         */
+	double sum, sum2;         /* Sums of (squared) loads.   */
+
+	/* Sanity check. */
+	assert(traffic != NULL);
+	assert(proc != NULL);
+	assert(map != NULL);
+	assert(ll != NULL);
+	assert(proc->regular);
+
+	W = proc->width;
+	H = proc->height;
+	D = proc->depth;
+	wrapx = (proc->torus) && (W > 2);
+	wrapy = (proc->torus) && (H > 2);
+	wrapz = (proc->torus) && (D > 2);
+	rows = (long)D*H*(W + 1);
+	cols = (long)D*W*(H + 1);
+	pillars = (long)H*W*(D + 1);
+	size = 2*(rows + cols + pillars);
+	nthreads = omp_get_max_threads();
+	diff = scalloc(nthreads*size, sizeof(double));
+
+	/* Gather process locations. */
+	x = smalloc(traffic->nvertices*sizeof(int));
+	y = smalloc(traffic->nvertices*sizeof(int));
+	z = smalloc(traffic->nvertices*sizeof(int));
+	for (int i = 0; i < traffic->nvertices; i++)
+	{
+		x[i] = proc->x[map[i]];
+		y[i] = proc->y[map[i]];
+		z[i] = proc->z[map[i]];
+	}
+
+	/* Route traffic. */
+	#pragma omp parallel num_threads(nthreads)
+	{
+		double *east = &diff[omp_get_thread_num()*size];
+		double *west = east + rows;
+		double *north = west + rows;
+		double *south = north + cols;
+		double *up = south + cols;
+		double *down = up + pillars;
+
+		#pragma omp for schedule(dynamic, 64)
+		for (int i = 0; i < traffic->nvertices; i++)
+		{
+			for (int k = traffic->offsets[i]; k < traffic->offsets[i + 1]; k++)
+			{
+				int len, dir;
+				long line;
+				int j = traffic->adjacency[k];
+				double w = traffic->weights[k]/2;
+
+				if (j == i)
+					continue;
+
+				/* X first, along the row of source process. */
+				line = ((long)z[i]*H + y[i])*(W + 1);
+				len = hops(x[i], x[j], W, wrapx, &dir);
+				if ((len > 0) && (dir > 0))
+					span(&east[line], W, x[i], len, w);
+				else if (len > 0)
+					span(&west[line], W, x[i] - len + 1, len, w);
+
+				/* Y next, along the column of target process. */
+				line = ((long)z[i]*W + x[j])*(H + 1);
+				len = hops(y[i], y[j], H, wrapy, &dir);
+				if ((len > 0) && (dir > 0))
+					span(&south[line], H, y[i], len, w);
+				else if (len > 0)
+					span(&north[line], H, y[i] - len + 1, len, w);
+
+				/* Z last, along the pillar of target process. */
+				line = ((long)y[j]*W + x[j])*(D + 1);
+				len = hops(z[i], z[j], D, wrapz, &dir);
+				if ((len > 0) && (dir > 0))
+					span(&up[line], D, z[i], len, w);
+				else if (len > 0)
+					span(&down[line], D, z[i] - len + 1, len, w);
+			}
+		}
+	}
+
+	/* Merge difference arrays. */
+	for (int t = 1; t < nthreads; t++)
+	{
+		for (long k = 0; k < size; k++)
+			diff[k] += diff[t*size + k];
+	}
+
+	/* Prefix sums. */
+	prefix(diff, 2L*D*H, W);
+	prefix(diff + 2*rows, 2L*D*W, H);
+	prefix(diff + 2*(rows + cols), 2L*H*W, D);
+
+	/* Gather link loads. */
+	ll->loads = smalloc(proc->ncores*NR_LINK_DIRECTIONS*sizeof(double));
+	for (int c = 0; c < proc->ncores; c++)
+	{
+		double *loads = &ll->loads[c*NR_LINK_DIRECTIONS];
+		long row = ((long)proc->z[c]*H + proc->y[c])*(W + 1) + proc->x[c];
+		long col = 2*rows + ((long)proc->z[c]*W + proc->x[c])*(H + 1) + proc->y[c];
+		long pillar = 2*(rows + cols) + ((long)proc->y[c]*W + proc->x[c])*(D + 1) + proc->z[c];
+
+		loads[LINK_EAST] = diff[row];
+		loads[LINK_WEST] = diff[row + rows];
+		loads[LINK_NORTH] = diff[col];
+		loads[LINK_SOUTH] = diff[col + cols];
+		loads[LINK_UP] = diff[pillar];
+		loads[LINK_DOWN] = diff[pillar + pillars];
+	}
+
+	/* Compute statistics. */
+	ll->nlinks = 0;
+	ll->maxload = 0.0;
+	sum = sum2 = 0.0;
+	for (int c = 0; c < proc->ncores; c++)
+	{
+		for (int dir = 0; dir < NR_LINK_DIRECTIONS; dir++)
+		{
+			double load = ll->loads[c*NR_LINK_DIRECTIONS + dir];
+
+			if (!link_exists(proc, c, dir))
+				continue;
+
+			ll->nlinks++;
+			sum += load;
+			sum2 += load*load;
+			if (load > ll->maxload)
+				ll->maxload = load;
+		}
+	}
+	ll->avgload = (ll->nlinks > 0) ? sum/ll->nlinks : 0.0;
+	ll->stddev = (ll->nlinks > 0) ? sqrt(fabs(sum2/ll->nlinks - ll->avgload*ll->avgload)) : 0.0;
+
+	/* House keeping. */
+	free(z);
+	free(y);
+	free(x);
+	free(diff);
+}
+
+/**
+ * @brief Dumps link loads.
+ *
+ * @details Writes one line per directed link, with the location of the source
+ *          core, the link direction (E, W, N, S, U or D) and the link load.
+ *
+ * @param proc Processor's topology.
+ * @param ll   Link load evaluation.
+ * @param file Output file.
+ */
+void linkload_dump(const struct processor *proc, const struct linkload *ll, FILE *file)
+{
+	static const char dirs[NR_LINK_DIRECTIONS] = {'E', 'W', 'N', 'S', 'U', 'D'};
+
+	/* Sanity check. */
+	assert(proc != NULL);
+	assert(ll != NULL);
+	assert(file != NULL);
+
+	for (int c = 0; c < proc->ncores; c++)
+	{
+		for (int dir = 0; dir < NR_LINK_DIRECTIONS; dir++)
+		{
+			if (!link_exists(proc, c, dir))
+				continue;
+
+			fprintf(file, "%d %d %d %c %lf\n",
+				proc->x[c], proc->y[c], proc->z[c], dirs[dir], ll->loads[c*NR_LINK_DIRECTIONS + dir]);
+		}
+	}
+}
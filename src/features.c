@@ -0,0 +1,180 @@
+/*
+ * Copyright(C) 2015 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Mapper.
+ *
+ * Mapper is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Mapper is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MyLib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <mylib/util.h>
+
+#include "cluster.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+	#include <immintrin.h>
+#endif
+
+/**
+ * @brief Alignment of rows (in bytes).
+ */
+#define FEATURES_ALIGNMENT 64
+
+/**
+ * @brief Floats in an aligned block.
+ */
+#define FEATURES_BLOCK (FEATURES_ALIGNMENT/sizeof(float))
+
+/**
+ * @brief Squared distance between two rows (portable kernel).
+ */
+static float distance_scalar(const float *a, const float *b, int n)
+{
+	float sum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+	
+	for (int i = 0; i < n; i += 4)
+	{
+		for (int j = 0; j < 4; j++)
+		{
+			float d = a[i + j] - b[i + j];
+			
+			sum[j] += d*d;
+		}
+	}
+	
+	return ((sum[0] + sum[1]) + (sum[2] + sum[3]));
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+/**
+ * @brief Squared distance between two rows (AVX2 kernel).
+ */
+__attribute__((target("avx2,fma")))
+static float distance_avx2(const float *a, const float *b, int n)
+{
+	__m128 lo, hi;                     /* Halves of accumulator. */
+	__m256 sum0 = _mm256_setzero_ps(); /* Even accumulator.      */
+	__m256 sum1 = _mm256_setzero_ps(); /* Odd accumulator.       */
+	
+	for (int i = 0; i < n; i += 16)
+	{
+		__m256 d0 = _mm256_sub_ps(_mm256_load_ps(&a[i]), _mm256_load_ps(&b[i]));
+		__m256 d1 = _mm256_sub_ps(_mm256_load_ps(&a[i + 8]), _mm256_load_ps(&b[i + 8]));
+		
+		sum0 = _mm256_fmadd_ps(d0, d0, sum0);
+		sum1 = _mm256_fmadd_ps(d1, d1, sum1);
+	}
+	
+	sum0 = _mm256_add_ps(sum0, sum1);
+	lo = _mm256_castps256_ps128(sum0);
+	hi = _mm256_extractf128_ps(sum0, 1);
+	lo = _mm_add_ps(lo, hi);
+	lo = _mm_hadd_ps(lo, lo);
+	lo = _mm_hadd_ps(lo, lo);
+	
+	return (_mm_cvtss_f32(lo));
+}
+
+/**
+ * @brief Squared distance between two rows (AVX-512 kernel).
+ */
+__attribute__((target("avx512f")))
+static float distance_avx512(const float *a, const float *b, int n)
+{
+	__m512 sum = _mm512_setzero_ps(); /* Accumulator. */
+	
+	for (int i = 0; i < n; i += 16)
+	{
+		__m512 d = _mm512_sub_ps(_mm512_load_ps(&a[i]), _mm512_load_ps(&b[i]));
+		
+		sum = _mm512_fmadd_ps(d, d, sum);
+	}
+	
+	return (_mm512_reduce_add_ps(sum));
+}
+
+#endif
+
+/**
+ * @brief Chooses the fastest distance kernel that the processor supports.
+ */
+static float (*distance_kernel(void))(const float *, const float *, int)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512f"))
+		return (distance_avx512);
+	if ((__builtin_cpu_supports("avx2")) && (__builtin_cpu_supports("fma")))
+		return (distance_avx2);
+#endif
+	
+	return (distance_scalar);
+}
+
+/**
+ * @brief Creates a block of features.
+ * 
+ * @details Rows are padded with zeros up to a multiple of 64 bytes, and
+ *          aligned to 64 bytes, so that distance kernels need neither
+ *          unaligned loads nor remainder loops.
+ * 
+ * @param npoints   Number of points.
+ * @param dimension Dimension of points.
+ * 
+ * @returns A zeroed block of features.
+ */
+struct features *features_create(int npoints, int dimension)
+{
+	void *data;         /* Rows.              */
+	size_t size;        /* Size of rows.      */
+	struct features *f; /* Block of features. */
+	
+	/* Sanity check. */
+	assert(npoints > 0);
+	assert(dimension > 0);
+	
+	f = smalloc(sizeof(struct features));
+	f->npoints = npoints;
+	f->dimension = dimension;
+	f->stride = ((dimension + FEATURES_BLOCK - 1)/FEATURES_BLOCK)*FEATURES_BLOCK;
+	f->kernel = distance_kernel();
+	
+	size = (size_t)npoints*f->stride*sizeof(float);
+	if (posix_memalign(&data, FEATURES_ALIGNMENT, size) != 0)
+		error("cannot allocate memory");
+	memset(data, 0, size);
+	f->data = data;
+	
+	return (f);
+}
+
+/**
+ * @brief Destroys a block of features.
+ * 
+ * @param f Target block of features.
+ */
+void features_destroy(struct features *f)
+{
+	/* Sanity check. */
+	assert(f != NULL);
+	
+	free(f->data);
+	free(f);
+}
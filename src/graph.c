@@ -0,0 +1,317 @@
+/*
+ * Copyright(C) 2015 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Mapper.
+ *
+ * Mapper is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Mapper is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MyLib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <assert.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include <mylib/util.h>
+
+#include "mapper.h"
+
+/**
+ * @brief Adjacency list entry.
+ */
+struct entry
+{
+	int vertex;    /**< Target vertex. */
+	double weight; /**< Edge weight.   */
+};
+
+/**
+ * @brief Compares two adjacency list entries.
+ */
+static int entry_cmp(const void *a, const void *b)
+{
+	return (((const struct entry *)a)->vertex - ((const struct entry *)b)->vertex);
+}
+
+/**
+ * @brief Creates a communication graph out of several record buffers.
+ *
+ * @details Builds a symmetric communication graph in compressed sparse row
+ *          format out of @p nbuffers buffers of communication records. Each
+ *          record contributes its cost to both (src, dest) and (dest, src)
+ *          pairs, or once to (src, src) for a self-record, and repeated
+ *          pairs are merged. Buffers are counted and
+ *          scattered in parallel: each buffer gets its own slots in every
+ *          adjacency list, so no synchronization is needed.
+ *
+ * @param nvertices Number of vertices (processes).
+ * @param edges     Buffers of communication records.
+ * @param nedges    Number of communication records in each buffer.
+ * @param nbuffers  Number of buffers.
+ *
+ * @returns A communication graph.
+ */
+struct graph *graph_merge
+(int nvertices, const struct edge *const *edges, const int *nedges, int nbuffers)
+{
+	long total;            /* Number of entries.         */
+	int *next;             /* Next free slot per buffer. */
+	int *length;           /* Merged list lengths.       */
+	struct graph *g;       /* Communication graph.       */
+	struct entry *entries; /* Adjacency list entries.    */
+
+	/* Sanity check. */
+	assert(nvertices > 0);
+	assert(edges != NULL);
+	assert(nedges != NULL);
+	assert(nbuffers > 0);
+
+	g = smalloc(sizeof(struct graph));
+	g->nvertices = nvertices;
+	g->base = NULL;
+	g->size = 0;
+	g->offsets = smalloc((nvertices + 1)*sizeof(int));
+
+	next = scalloc((long)nbuffers*nvertices, sizeof(int));
+	length = smalloc(nvertices*sizeof(int));
+
+	/* Count entries per vertex. */
+	#pragma omp parallel for schedule(dynamic)
+	for (int b = 0; b < nbuffers; b++)
+	{
+		int *count = &next[(long)b*nvertices];
+
+		for (int i = 0; i < nedges[b]; i++)
+		{
+			const struct edge *e = &edges[b][i];
+
+			if ((e->src < 0) || (e->src >= nvertices))
+				error("invalid process %d", e->src);
+			if ((e->dest < 0) || (e->dest >= nvertices))
+				error("invalid process %d", e->dest);
+
+			count[e->src]++;
+			if (e->dest != e->src)
+				count[e->dest]++;
+		}
+	}
+
+	/* Assign slots. */
+	total = 0;
+	for (int i = 0; i < nvertices; i++)
+	{
+		g->offsets[i] = total;
+		for (int b = 0; b < nbuffers; b++)
+		{
+			int n = next[(long)b*nvertices + i];
+
+			next[(long)b*nvertices + i] = total;
+			total += n;
+		}
+	}
+	g->offsets[nvertices] = total;
+	if (total > INT_MAX)
+		error("too many communication records");
+
+	/* Scatter entries. */
+	entries = smalloc((total + 1)*sizeof(struct entry));
+	#pragma omp parallel for schedule(dynamic)
+	for (int b = 0; b < nbuffers; b++)
+	{
+		int *slot = &next[(long)b*nvertices];
+
+		for (int i = 0; i < nedges[b]; i++)
+		{
+			int k;
+			const struct edge *e = &edges[b][i];
+
+			k = slot[e->src]++;
+			entries[k].vertex = e->dest;
+			entries[k].weight = e->cost;
+
+			/* Self-records are stored once. */
+			if (e->dest == e->src)
+				continue;
+
+			k = slot[e->dest]++;
+			entries[k].vertex = e->src;
+			entries[k].weight = e->cost;
+		}
+	}
+
+	/* Sort and merge adjacency lists. */
+	#pragma omp parallel for schedule(dynamic, 64)
+	for (int i = 0; i < nvertices; i++)
+	{
+		int k;
+		int begin = g->offsets[i];
+		int end = g->offsets[i + 1];
+
+		qsort(&entries[begin], end - begin, sizeof(struct entry), entry_cmp);
+
+		k = begin;
+		for (int j = begin; j < end; j++)
+		{
+			if ((k > begin) && (entries[k - 1].vertex == entries[j].vertex))
+				entries[k - 1].weight += entries[j].weight;
+			else
+				entries[k++] = entries[j];
+		}
+		length[i] = k - begin;
+	}
+
+	/* Build adjacency lists. */
+	g->nedges = 0;
+	for (int i = 0; i < nvertices; i++)
+	{
+		int begin = g->offsets[i];
+
+		g->offsets[i] = g->nedges;
+		g->nedges += length[i];
+		length[i] = begin;
+	}
+	g->offsets[nvertices] = g->nedges;
+	g->adjacency = smalloc((g->nedges + 1)*sizeof(int));
+	g->weights = smalloc((g->nedges + 1)*sizeof(double));
+	#pragma omp parallel for schedule(dynamic, 64)
+	for (int i = 0; i < nvertices; i++)
+	{
+		for (int k = g->offsets[i], j = length[i]; k < g->offsets[i + 1]; k++, j++)
+		{
+			g->adjacency[k] = entries[j].vertex;
+			g->weights[k] = entries[j].weight;
+		}
+	}
+
+	/* House keeping. */
+	free(entries);
+	free(length);
+	free(next);
+
+	return (g);
+}
+
+/**
+ * @brief Creates a communication graph.
+ *
+ * @details Builds a symmetric communication graph in compressed sparse row
+ *          format out of a list of communication records.
+ *
+ * @param nvertices Number of vertices (processes).
+ * @param edges     Communication records.
+ * @param nedges    Number of communication records.
+ *
+ * @returns A communication graph.
+ *
+ * @see graph_merge()
+ */
+struct graph *graph_create(int nvertices, const struct edge *edges, int nedges)
+{
+	return (graph_merge(nvertices, &edges, &nedges, 1));
+}
+
+/**
+ * @brief Pads a communication graph with isolated vertices.
+ *
+ * @param g         Communication graph.
+ * @param nvertices Number of vertices of the padded graph.
+ *
+ * @returns A copy of @p g with @p nvertices vertices, the extra ones having
+ *          no edges.
+ */
+struct graph *graph_pad(const struct graph *g, int nvertices)
+{
+	struct graph *padded;
+
+	/* Sanity check. */
+	assert(g != NULL);
+	assert(nvertices >= g->nvertices);
+
+	padded = smalloc(sizeof(struct graph));
+	padded->nvertices = nvertices;
+	padded->nedges = g->nedges;
+	padded->base = NULL;
+	padded->size = 0;
+	padded->offsets = smalloc((nvertices + 1)*sizeof(int));
+	padded->adjacency = smalloc((g->nedges + 1)*sizeof(int));
+	padded->weights = smalloc((g->nedges + 1)*sizeof(double));
+
+	memcpy(padded->offsets, g->offsets, (g->nvertices + 1)*sizeof(int));
+	for (int i = g->nvertices + 1; i <= nvertices; i++)
+		padded->offsets[i] = g->nedges;
+	memcpy(padded->adjacency, g->adjacency, g->nedges*sizeof(int));
+	memcpy(padded->weights, g->weights, g->nedges*sizeof(double));
+
+	return (padded);
+}
+
+/**
+ * @brief Destroys a communication graph.
+ *
+ * @param g Target communication graph.
+ */
+void graph_destroy(struct graph *g)
+{
+	/* Sanity check. */
+	assert(g != NULL);
+
+	/* Graph is backed by a file mapping. */
+	if (g->base != NULL)
+		munmap(g->base, g->size);
+	else
+	{
+		free(g->weights);
+		free(g->adjacency);
+		free(g->offsets);
+	}
+	free(g);
+}
+
+/**
+ * @brief Gets the communication cost between two vertices.
+ *
+ * @param g Communication graph.
+ * @param i Source vertex.
+ * @param j Target vertex.
+ *
+ * @returns The communication cost between vertices @p i and @p j.
+ */
+double graph_get(const struct graph *g, int i, int j)
+{
+	int lo, hi;
+
+	/* Sanity check. */
+	assert(g != NULL);
+	assert((i >= 0) && (i < g->nvertices));
+	assert((j >= 0) && (j < g->nvertices));
+
+	/* Binary search. */
+	lo = g->offsets[i];
+	hi = g->offsets[i + 1] - 1;
+	while (lo <= hi)
+	{
+		int mid = lo + (hi - lo)/2;
+
+		if (g->adjacency[mid] == j)
+			return (g->weights[mid]);
+		else if (g->adjacency[mid] < j)
+			lo = mid + 1;
+		else
+			hi = mid - 1;
+	}
+
+	return (0.0);
+}
@@ -17,40 +17,40 @@
  * along with MyLib. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <assert.h>
+#include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
-#include <mylib/queue.h>
 #include <mylib/util.h>
-#include <mylib/vector.h>
-#include <mylib/matrix.h>
 
+#include "heap.h"
 #include "mapper.h"
 
 /**
  * @brief Looks for the best thread not yet mapped.
  * 
- * @param threads  Communication costs.
- * @param nthreads Number of threads.
+ * @param threads Communication graph.
  * 
  * @returns The ID of the best thread not yet mapped.
  */
-static int best_thread(const vector_t *threads, int nthreads)
+static int best_thread(const struct graph *threads)
 {
 	int best;      /* Best thread id.            */
 	double *costs; /* Total communication costs. */
 	
-	costs = scalloc(nthreads, sizeof(double));
+	costs = scalloc(threads->nvertices, sizeof(double));
 	
 	/* Compute total costs. */
-	for (int i = 0; i < nthreads; i++)
+	for (int i = 0; i < threads->nvertices; i++)
 	{
-		for (int j = 0; j < nthreads; j++)
-			costs[i] += vector_get(threads[i], j);
+		for (int k = threads->offsets[i]; k < threads->offsets[i + 1]; k++)
+			costs[i] += threads->weights[k];
 	}
 	
 	/* Look for best thread. */
 	best = 0;
-	for (int i = 1; i < nthreads; i++)
+	for (int i = 1; i < threads->nvertices; i++)
 	{
 		if (costs[i] > costs[best])
 			best = i;
@@ -77,7 +77,7 @@ static int best_core(const struct processor *proc)
 	best = 0;
 	for (int i = 1; i < proc->ncores; i++)
 	{
-		if (proc->nlinks[i] > proc->nlinks[best])
+		if (processor_degree(proc, i) > processor_degree(proc, best))
 			best = i;
 	}
 	
@@ -88,216 +88,285 @@ static int best_core(const struct processor *proc)
 /**
  * @brief Looks for the best neighbor thread not yet mapped.
  * 
- * @param thread Thread communication cost.
- * @param map    Current thread map.
- * @param nprocs Number of threads.
+ * @param threads  Communication graph.
+ * @param threadid ID of target thread.
+ * @param map      Current thread map.
+ * @param next     Lowest ID of a thread that may not be mapped.
  * 
  * @returns The ID of the best thread.
  */
-static int best_neighbor_thread(vector_t thread, int *map, int nthreads)
+static int best_neighbor_thread
+(const struct graph *threads, int threadid, const int *map, int *next)
 {
 	int best;
 	
 	/* Look for the best neighbor thread. */
 	best = -1;
-	for (int i = 0; i < nthreads; i++)
+	for (int k = threads->offsets[threadid]; k < threads->offsets[threadid + 1]; k++)
 	{
+		int i = threads->adjacency[k];
+		
 		/* Skip mapped threads. */
 		if (map[i] >= 0)
 			continue;
 		
-		/* First non-mapped thread. */
-		if (best < 0)
-		{
-			best = i;
+		/* Skip threads that do not communicate. */
+		if (threads->weights[k] <= 0.0)
 			continue;
-		}
 		
 		/* Best thread found. */
-		if (vector_get(thread, i) > vector_get(thread, best))
-			best = i;
+		if ((best < 0) || (threads->weights[k] > threads->weights[best]))
+			best = k;
 	}
 	
-	return (best);
+	/* Best neighbor thread found. */
+	if (best >= 0)
+		return (threads->adjacency[best]);
+	
+	/* First non-mapped thread. */
+	while (map[*next] >= 0)
+		(*next)++;
+	
+	return (*next);
 }
 
 /**
- * @brief Task.
+ * @brief Core search state.
  */
-struct task
+struct search
 {
-	int coreid; /**< Core ID. */
-	int radius; /**< Radius.  */
+	uint64_t *occupied; /**< Occupancy bitmap.           */
+	int *frontier;      /**< Breadth-first search queue. */
+	unsigned *visited;  /**< Visit stamps.               */
+	unsigned stamp;     /**< Current visit stamp.        */
+	int minweight;      /**< Cost of cheapest link.      */
 };
 
 /**
- * @brief Creates a task.
- * 
- * @param coreid Core ID.
- * @param radius Radius to origin core.
- * 
- * @returns A task.
+ * @brief Initializes a core search state.
+ *
+ * @param s    Target search state.
+ * @param proc Processor's information.
  */
-static struct task *task_create(int coreid, int radius)
+static void search_init(struct search *s, const struct processor *proc)
 {
-	struct task *t;
-	
-	/* Create task. */
-	t = smalloc(sizeof(struct task));
-	t->coreid = coreid;
-	t->radius = radius;
+	s->occupied = scalloc((proc->ncores + 63)/64, sizeof(uint64_t));
+	s->frontier = smalloc(proc->ncores*sizeof(int));
+	s->visited = scalloc(proc->ncores, sizeof(unsigned));
+	s->stamp = 0;
 	
-	return (t);
+	/* Cost of cheapest link. */
+	s->minweight = 1;
+	if (proc->weights != NULL)
+	{
+		s->minweight = proc->weights[0];
+		for (int k = 1; k < proc->offsets[proc->ncores]; k++)
+		{
+			if (proc->weights[k] < s->minweight)
+				s->minweight = proc->weights[k];
+		}
+	}
 }
 
 /**
- * @brief Destroys a task.
- * 
- * @param t Target task.
+ * @brief Releases a core search state.
+ *
+ * @param s Target search state.
+ */
+static void search_destroy(struct search *s)
+{
+	free(s->visited);
+	free(s->frontier);
+	free(s->occupied);
+}
+
+/**
+ * @brief Marks a core as in use.
  */
-static void task_destroy(struct task *t)
+static inline void core_use(struct search *s, int coreid)
 {
-	free(t);
+	s->occupied[coreid >> 6] |= UINT64_C(1) << (coreid & 63);
 }
 
 /**
  * @brief Asserts if a core is in use.
  * 
- * @param map      Thread map.
- * @param nthreads Number of threads.
- * @param coreid   ID of target core.
+ * @param s      Search state.
+ * @param coreid ID of target core.
  * 
  * @returns True if the core is in use, and false otherwise.
  */
-static bool core_in_use(int *map, int nthreads, int coreid)
+static inline bool core_in_use(const struct search *s, int coreid)
 {
-	for (int i = 0; i < nthreads; i++)
-	{
-		if (map[i] == coreid)
-			return (true);
-	}
-	
-	return (false);
+	return ((s->occupied[coreid >> 6] >> (coreid & 63)) & 1);
 }
 
 /**
  * @brief Looks for the best neighbor core not in use.
  * 
- * @param core    Processor's information.
- * @param map     Thread map.
- * @param nthread Number of threads.
- * @param coreid  ID of target core.
+ * @details Runs a breadth-first search from @p coreid and stops at the first
+ *          level that has a free core. Among free cores on that level, the
+ *          one with most links wins, and ties are broken by search order.
+ *          Cores are marked with a per-search stamp, so that each core is
+ *          visited at most once and no state needs to be cleared.
+ * 
+ *          When links have distinct costs, a free core a few hops away may
+ *          be closer than one on the first level (e.g. across a chip
+ *          boundary), so the search goes on while further levels may still
+ *          hold a closer core, and the closest free core wins instead.
+ * 
+ * @param proc   Processor's information.
+ * @param s      Search state.
+ * @param coreid ID of target core.
+ * 
+ * @returns The ID of the best core.
  */
 static int best_neighbor_core
-(const struct processor *proc, int *map, int nthreads, int coreid)
+(const struct processor *proc, struct search *s, int coreid)
 {
-	int best_coreid;   /* ID of best core.  */
-	int *states;       /* Processing state. */
-	struct task *best; /* Best processor.   */
-	struct task *t;    /* Working task.     */
-	queue_t tasks;     /* Tasks to process. */
-	
-	/* Processing states. */
-	enum states {NOT_VISITED, VISITING, VISITED};
-	
-	tasks = queue_create(NULL);
+	int best;       /* ID of best core.       */
+	int bestdist;   /* Distance to best core. */
+	int head, tail; /* Frontier bounds.       */
+	int level;      /* End of current level.  */
+	int hops;       /* Hops of current level. */
 	
-	/* Initialize processing states. */
-	states = smalloc(proc->ncores*sizeof(int));
-	for (int i = 0; i < proc->ncores; i++)
-		states[i] = NOT_VISITED;
-	
-	/* Enqueue all neighbors. */
-	for (int i = 0; i < proc->ncores; i++)
+	/* Reset visit stamps on wraparound. */
+	if (++s->stamp == 0)
 	{
-		if (proc->topology[coreid][i])
-		{
-			states[i] = VISITING;
-			queue_enqueue(tasks, task_create(coreid, 1));
-		}
+		memset(s->visited, 0, proc->ncores*sizeof(unsigned));
+		s->stamp = 1;
 	}
 	
+	head = tail = 0;
+	s->frontier[tail++] = coreid;
+	s->visited[coreid] = s->stamp;
+	
 	/* Look for the best neighbor core. */
-	best = NULL;
-	while (true)
+	best = -1;
+	bestdist = 0;
+	for (hops = 1; head < tail; hops++)
 	{
-		t = queue_dequeue(tasks);
+		/* No closer core ahead. */
+		if ((best >= 0) && ((proc->weights == NULL) || (hops*s->minweight > bestdist)))
+			break;
 		
-		/* Enqueue all neighbors. */
-		for (int i = 0; i < proc->ncores; i++)
+		/* Visit next level. */
+		level = tail;
+		while (head < level)
 		{
-			if (proc->topology[t->coreid][i])
+			int c = s->frontier[head++];
+			
+			for (int k = proc->offsets[c]; k < proc->offsets[c + 1]; k++)
 			{
-				states[i] = VISITING;
-				queue_enqueue(tasks, task_create(i, t->radius + 1));
+				int dist;
+				int i = proc->neighbors[k];
+				
+				if (s->visited[i] == s->stamp)
+					continue;
+				
+				s->visited[i] = s->stamp;
+				s->frontier[tail++] = i;
+				
+				/* Skip cores that are in use. */
+				if (core_in_use(s, i))
+					continue;
+				
+				dist = (proc->weights == NULL) ? hops : processor_distance(proc, coreid, i);
+				
+				/* Best core found. */
+				if ((best < 0) || (dist < bestdist) ||
+				    ((dist == bestdist) && (processor_degree(proc, i) > processor_degree(proc, best))))
+					best = i, bestdist = dist;
 			}
 		}
+	}
+	
+	assert(best >= 0);
+	
+	return (best);
+}
+
+/**
+ * @brief Updates the affinity of unmapped threads.
+ *
+ * @details Adds the traffic of every unmapped neighbor of @p threadid with
+ *          @p threadid to its accumulated traffic with mapped threads.
+ *
+ * @param threads  Communication graph.
+ * @param threadid ID of newly mapped thread.
+ * @param gains    Accumulated traffic of unmapped threads.
+ */
+static void update_affinity
+(const struct graph *threads, int threadid, struct heap *gains)
+{
+	for (int k = threads->offsets[threadid]; k < threads->offsets[threadid + 1]; k++)
+	{
+		int i = threads->adjacency[k];
 		
-		states[t->coreid] = VISITED;
-		
-		/* Skip cores that are in use. */
-		if (core_in_use(map, nthreads, t->coreid))
-		{
-			task_destroy(t);
-			continue;
-		}
-		
-		/* First core that is not in use. */
-		if (best == NULL)
-		{
-			best = t;
+		if (!heap_contains(gains, i))
 			continue;
-		}
 		
-		/* Done. */
-		if (t->radius > best->radius)
-		{
-			task_destroy(t);
-			break;
-		}
+		heap_update(gains, i, heap_key(gains, i) + threads->weights[k]);
+	}
+}
+
+/**
+ * @brief Looks for the core of the heaviest mapped partner of a thread.
+ *
+ * @param threads  Communication graph.
+ * @param threadid ID of target thread.
+ * @param map      Current thread map.
+ * @param coreid   Fallback core.
+ *
+ * @returns The core of the mapped thread that communicates the most with
+ *          @p threadid, or @p coreid if there is none.
+ */
+static int best_partner_core
+(const struct graph *threads, int threadid, const int *map, int coreid)
+{
+	int best;
+	
+	best = -1;
+	for (int k = threads->offsets[threadid]; k < threads->offsets[threadid + 1]; k++)
+	{
+		int i = threads->adjacency[k];
 		
-		/* Best core found. */
-		if (t->radius == best->radius)
-		{
-			if (proc->nlinks[t->coreid] > proc->nlinks[best->coreid])
-			{
-				task_destroy(best);
-				best = t;
-				continue;
-			}
-		}
+		/* Skip unmapped threads. */
+		if ((i == threadid) || (map[i] < 0))
+			continue;
 		
-		task_destroy(t);
+		if ((best < 0) || (threads->weights[k] > threads->weights[best]))
+			best = k;
 	}
 	
-	best_coreid = best->coreid;
-	
-	/* House keeping. */
-	task_destroy(best);
-	while (!queue_empty(tasks))
-		task_destroy(queue_dequeue(tasks));
-	queue_destroy(tasks);
-	free(states);
-	
-	return (best_coreid);
+	return ((best < 0) ? coreid : map[threads->adjacency[best]]);
 }
 
 /**
  * @brief Maps threads using a greedy heuristic.
  *
- * @param communication Communication matrix.
+ * @details By default, the next thread is the one that communicates the most
+ *          with the last mapped thread, and it is placed next to it. In
+ *          affinity mode, the next thread is the one with the most traffic
+ *          to all mapped threads, kept in an indexed max-heap that is only
+ *          updated along the edges of each newly mapped thread, and it is
+ *          placed next to its heaviest mapped partner.
+ *
+ * @param communication Communication graph.
  * @param args          Additional arguments.
  *
  * @returns A process map.
  */
-int *map_greedy(matrix_t communication, void *args)
+int *map_greedy(const struct graph *communication, void *args)
 {
 	int *map;               /* Thread map.              */
 	int threadid;           /* Best thread.             */
 	int coreid;             /* Best core.               */
+	int next;               /* First unmapped thread.   */
 	struct processor *proc; /* Processor's information. */
 	int nthreads;           /* Number of threads.       */
-	vector_t *threads;      /* Threads.                 */
+	struct search search;   /* Core search state.       */
+	struct heap *gains;     /* Affinity of threads.     */
 	
 	/* Sanity check. */
 	assert(communication != NULL);
@@ -305,40 +374,57 @@ int *map_greedy(matrix_t communication, void *args)
 	
 	proc = ((struct greedy_args *)args)->proc;
 	
-	nthreads = matrix_height(communication);
-	
-	/* Create processes. */
-	threads = smalloc(nthreads*sizeof(vector_t));
-	for (int i = 0; i < nthreads; i++)
-	{
-		threads[i] = vector_create(nthreads);
-		for (int j = 0; j < nthreads; j++)
-			vector_set(threads[i], j, matrix_get(communication, i, j));
-	}
+	nthreads = communication->nvertices;
 	
 	/* Initialize process map. */
 	map = smalloc(nthreads*sizeof(int));
 	for (int i = 0; i < nthreads; i++)
 		map[i] = -1;
 	
-	threadid = best_thread(threads, nthreads);
+	search_init(&search, proc);
+	
+	threadid = best_thread(communication);
 	coreid = best_core(proc);
 	
 	map[threadid] = coreid;
+	core_use(&search, coreid);
+	
+	/* Initialize affinities. */
+	gains = NULL;
+	if (((struct greedy_args *)args)->affinity)
+	{
+		gains = heap_create(nthreads);
+		for (int i = 0; i < nthreads; i++)
+		{
+			if (i != threadid)
+				heap_insert(gains, i, 0.0);
+		}
+		update_affinity(communication, threadid, gains);
+	}
 	
 	/* Map all threads. */
+	next = 0;
 	for (int i = 1; i < nthreads; i++)
 	{
-		threadid = best_neighbor_thread(threads[threadid], map, nthreads);
-		coreid = best_neighbor_core(proc, map, nthreads, coreid);
+		if (gains != NULL)
+		{
+			threadid = heap_pop(gains);
+			coreid = best_partner_core(communication, threadid, map, coreid);
+			update_affinity(communication, threadid, gains);
+		}
+		else
+			threadid = best_neighbor_thread(communication, threadid, map, &next);
+		
+		coreid = best_neighbor_core(proc, &search, coreid);
 		
 		map[threadid] = coreid;
+		core_use(&search, coreid);
 	}
-
+	
 	/* House keeping. */
-	for (int i = 0; i < nthreads; i++)
-		vector_destroy(threads[i]);
-	free(threads);
+	if (gains != NULL)
+		heap_destroy(gains);
+	search_destroy(&search);
 	
 	return (map);
 }
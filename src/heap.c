@@ -0,0 +1,235 @@
+/*
+ * Copyright(C) 2015 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Mapper.
+ *
+ * Mapper is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Mapper is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MyLib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+
+#include <mylib/util.h>
+
+#include "heap.h"
+
+/**
+ * @brief Asserts if an item should be above another one.
+ */
+static inline bool above(const struct heap *h, int a, int b)
+{
+	if (h->keys[a] != h->keys[b])
+		return (h->keys[a] > h->keys[b]);
+
+	return (a < b);
+}
+
+/**
+ * @brief Places an item at some position of a heap.
+ */
+static inline void place(struct heap *h, int i, int item)
+{
+	h->items[i] = item;
+	h->pos[item] = i;
+}
+
+/**
+ * @brief Moves an item up in a heap.
+ *
+ * @param h Target heap.
+ * @param i Position of the item.
+ */
+static void sift_up(struct heap *h, int i)
+{
+	int item = h->items[i];
+
+	while (i > 0)
+	{
+		int parent = (i - 1)/2;
+
+		if (!above(h, item, h->items[parent]))
+			break;
+
+		place(h, i, h->items[parent]);
+		i = parent;
+	}
+
+	place(h, i, item);
+}
+
+/**
+ * @brief Moves an item down in a heap.
+ *
+ * @param h Target heap.
+ * @param i Position of the item.
+ */
+static void sift_down(struct heap *h, int i)
+{
+	int item = h->items[i];
+
+	while (true)
+	{
+		int child = 2*i + 1;
+
+		if (child >= h->size)
+			break;
+
+		/* Pick the largest child. */
+		if ((child + 1 < h->size) && (above(h, h->items[child + 1], h->items[child])))
+			child++;
+
+		if (!above(h, h->items[child], item))
+			break;
+
+		place(h, i, h->items[child]);
+		i = child;
+	}
+
+	place(h, i, item);
+}
+
+/**
+ * @brief Creates an indexed max-heap.
+ *
+ * @param capacity Maximum number of items.
+ *
+ * @returns An empty heap.
+ */
+struct heap *heap_create(int capacity)
+{
+	struct heap *h;
+
+	/* Sanity check. */
+	assert(capacity > 0);
+
+	h = smalloc(sizeof(struct heap));
+	h->size = 0;
+	h->capacity = capacity;
+	h->items = smalloc(capacity*sizeof(int));
+	h->pos = smalloc(capacity*sizeof(int));
+	h->keys = smalloc(capacity*sizeof(double));
+
+	for (int i = 0; i < capacity; i++)
+		h->pos[i] = -1;
+
+	return (h);
+}
+
+/**
+ * @brief Destroys an indexed max-heap.
+ *
+ * @param h Target heap.
+ */
+void heap_destroy(struct heap *h)
+{
+	/* Sanity check. */
+	assert(h != NULL);
+
+	free(h->keys);
+	free(h->pos);
+	free(h->items);
+	free(h);
+}
+
+/**
+ * @brief Inserts an item in a heap.
+ *
+ * @param h    Target heap.
+ * @param item Item.
+ * @param key  Key of the item.
+ */
+void heap_insert(struct heap *h, int item, double key)
+{
+	/* Sanity check. */
+	assert(h != NULL);
+	assert((item >= 0) && (item < h->capacity));
+	assert(!heap_contains(h, item));
+
+	h->keys[item] = key;
+	place(h, h->size++, item);
+	sift_up(h, h->size - 1);
+}
+
+/**
+ * @brief Changes the key of an item in a heap.
+ *
+ * @param h    Target heap.
+ * @param item Item.
+ * @param key  New key of the item.
+ */
+void heap_update(struct heap *h, int item, double key)
+{
+	double old;
+
+	/* Sanity check. */
+	assert(h != NULL);
+	assert(heap_contains(h, item));
+
+	old = h->keys[item];
+	h->keys[item] = key;
+
+	if (key > old)
+		sift_up(h, h->pos[item]);
+	else
+		sift_down(h, h->pos[item]);
+}
+
+/**
+ * @brief Removes an item from a heap.
+ *
+ * @param h    Target heap.
+ * @param item Item.
+ */
+void heap_remove(struct heap *h, int item)
+{
+	int i;
+	int last;
+
+	/* Sanity check. */
+	assert(h != NULL);
+	assert(heap_contains(h, item));
+
+	i = h->pos[item];
+	h->pos[item] = -1;
+	last = h->items[--h->size];
+
+	if (i == h->size)
+		return;
+
+	/* Fill hole with last item. */
+	place(h, i, last);
+	sift_up(h, i);
+	sift_down(h, h->pos[last]);
+}
+
+/**
+ * @brief Removes the item with the largest key from a heap.
+ *
+ * @param h Target heap.
+ *
+ * @returns The item with the largest key.
+ */
+int heap_pop(struct heap *h)
+{
+	int item;
+
+	/* Sanity check. */
+	assert(h != NULL);
+	assert(!heap_empty(h));
+
+	item = heap_top(h);
+	heap_remove(h, item);
+
+	return (item);
+}
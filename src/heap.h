@@ -0,0 +1,94 @@
+/*
+ * Copyright(C) 2015 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Mapper.
+ *
+ * Mapper is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Mapper is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MyLib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HEAP_H_
+#define HEAP_H_
+
+	#include <stdbool.h>
+
+	/**
+	 * @brief Indexed max-heap.
+	 *
+	 * @details Items are integers in [0, capacity) keyed by doubles. Keys of
+	 *          items in the heap can be changed in O(log n), and ties are
+	 *          broken by the lowest item, so that results are deterministic.
+	 */
+	struct heap
+	{
+		int size;     /**< Number of items in the heap. */
+		int capacity; /**< Maximum number of items.     */
+		int *items;   /**< Items, in heap order.        */
+		int *pos;     /**< Position of items (or -1).   */
+		double *keys; /**< Keys of items.               */
+	};
+
+	/**
+	 * @brief Asserts if a heap is empty.
+	 */
+	static inline bool heap_empty(const struct heap *h)
+	{
+		return (h->size == 0);
+	}
+
+	/**
+	 * @brief Asserts if an item is in a heap.
+	 */
+	static inline bool heap_contains(const struct heap *h, int item)
+	{
+		return (h->pos[item] >= 0);
+	}
+
+	/**
+	 * @brief Returns the key of an item.
+	 */
+	static inline double heap_key(const struct heap *h, int item)
+	{
+		return (h->keys[item]);
+	}
+
+	/**
+	 * @brief Returns the item with the largest key.
+	 */
+	static inline int heap_top(const struct heap *h)
+	{
+		return (h->items[0]);
+	}
+
+	/**
+	 * @brief Returns the item with the second largest key, or -1.
+	 */
+	static inline int heap_next(const struct heap *h)
+	{
+		if (h->size < 2)
+			return (-1);
+		if ((h->size == 2) || (h->keys[h->items[1]] >= h->keys[h->items[2]]))
+			return (h->items[1]);
+		
+		return (h->items[2]);
+	}
+
+	/* Forward definitions. */
+	extern struct heap *heap_create(int);
+	extern void heap_destroy(struct heap *);
+	extern void heap_insert(struct heap *, int, double);
+	extern void heap_update(struct heap *, int, double);
+	extern void heap_remove(struct heap *, int);
+	extern int heap_pop(struct heap *);
+
+#endif /* HEAP_H_ */
@@ -17,64 +17,187 @@
  * along with MyLib. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <assert.h>
+#include <math.h>
+#include <omp.h>
 #include <string.h>
 #include <stdlib.h>
 
-#include <mylib/algorithms.h>
-#include <mylib/matrix.h>
-#include <mylib/vector.h>
-#include <mylib/ai.h>
 #include <mylib/util.h>
-#include <mylib/table.h>
-#include <mylib/queue.h>
  
+#include "cluster.h"
+#include "heap.h"
 #include "mapper.h"
 
+/**
+ * @brief Returns the number of processes of a cluster.
+ * 
+ * @details Processes are spread as evenly as possible, so the first
+ *          n%k clusters hold one process more than the others.
+ */
+static inline int capacity(int n, int k, int j)
+{
+	return (n/k + ((j < n%k) ? 1 : 0));
+}
+
 #ifdef USE_AUCTION
 
+/**
+ * @brief Final bidding increment, relative to the range of distances.
+ */
 #define AUCTION_SLACK 0.001
 
+/**
+ * @brief Reduction factor of the bidding increment between phases.
+ */
+#define AUCTION_SCALING 8.0
+
 /**
  * @brief Balances processes evenly among clusters using auction's algorithm.
  * 
- * @param kdata Kmeans data.
+ * @details Clusters are auctioned as objects with capacity() similar slots
+ *          each, so the cost matrix is only n x k. Unassigned
+ *          processes bid for the cheapest slot of the cluster that is worth
+ *          the most to them, that is, the one that minimizes the distance to
+ *          the centroid plus the price of the slot. The bid raises that
+ *          price by the margin to the second best slot, which may be another
+ *          slot of the same cluster, plus an increment. Increments shrink
+ *          by AUCTION_SCALING between phases (epsilon-scaling), keeping
+ *          prices, until the assignment is within AUCTION_SLACK of the
+ *          range of distances of the optimum.
+ * 
+ * @param c Clustering.
  * 
  * @returns A balanced cluster map.
  */
-static int *balance(struct kmeans_data *kdata)
+static int *balance(const struct clustering *c)
 {
-	matrix_t m;            /* Auction's matrix.    */
-	int *balanced_map;     /* Process map.         */
-	int procs_per_cluster; /* Gotcha?              */
-	
-	if (kdata->npoints%kdata->ncentroids)
-		error("invalid number of clusters");
+	int n, k;             /* Problem size.                */
+	int *balanced_map;    /* Process map.                 */
+	int *base;            /* First slot of each cluster.  */
+	double *cost;         /* Distances to centroids.      */
+	double lo, hi;        /* Range of distances.          */
+	double eps, mineps;   /* Bidding increments.          */
+	int *owner;           /* Owner of each slot (or -1).  */
+	int *queue;           /* Unassigned processes.        */
+	struct heap **prices; /* Slots of each cluster.       */
+	
+	n = c->npoints;
+	k = c->ncentroids;
+	
+	balanced_map = smalloc(n*sizeof(int));
+	base = smalloc((k + 1)*sizeof(int));
+	cost = smalloc((size_t)n*k*sizeof(double));
+	owner = smalloc(n*sizeof(int));
+	queue = smalloc(n*sizeof(int));
+	
+	/* Compute distances. */
+	#pragma omp parallel for schedule(static)
+	for (int i = 0; i < n; i++)
+	{
+		for (int j = 0; j < k; j++)
+			cost[(size_t)i*k + j] = features_distance(c->points, clustering_point(c, i), features_row(c->centroids, j));
+	}
+	lo = hi = cost[0];
+	for (size_t i = 1; i < (size_t)n*k; i++)
+	{
+		if (cost[i] < lo)
+			lo = cost[i];
+		if (cost[i] > hi)
+			hi = cost[i];
+	}
 	
-	procs_per_cluster = kdata->npoints/kdata->ncentroids;
+	/* Slots of cluster j are numbered from base[j] on. */
+	prices = smalloc(k*sizeof(struct heap *));
+	base[0] = 0;
+	for (int j = 0; j < k; j++)
+	{
+		base[j + 1] = base[j] + capacity(n, k, j);
+		prices[j] = heap_create(base[j + 1] - base[j]);
+		for (int s = base[j]; s < base[j + 1]; s++)
+			heap_insert(prices[j], s - base[j], 0.0);
+	}
 	
-	m = matrix_create(kdata->npoints, kdata->npoints);
+	mineps = (hi > lo) ? AUCTION_SLACK*(hi - lo)/n : 1.0;
+	eps = (hi > lo) ? (hi - lo)/4 : 1.0;
+	if (eps < mineps)
+		eps = mineps;
 	
-	/* Build auction's matrix. */
-	for (int i = 0; i < kdata->npoints; i++)
+	/* Epsilon-scaling phases. */
+	while (true)
 	{
-		for (int j = 0; j < kdata->ncentroids; j++)
+		int head, nqueued;
+		
+		for (int i = 0; i < n; i++)
+			owner[i] = -1, queue[i] = i;
+		head = 0, nqueued = n;
+		
+		/* Auction. */
+		while (nqueued > 0)
 		{
-			double distance;
+			int i;            /* Bidder.                 */
+			int best;         /* Best cluster.           */
+			int s;            /* Slot on auction.        */
+			double v1, v2;    /* Best and second values. */
+			double increment; /* Price raise.            */
+			
+			i = queue[head];
+			head = (head + 1)%n;
+			nqueued--;
 			
-			distance = vector_distance(kdata->data[i], kdata->centroids[j]);
-			for (int k = 0; k < procs_per_cluster; k++)
-				matrix_set(m, i, procs_per_cluster*j + k, distance);
+			/* Look for the best and second best slots. */
+			best = -1;
+			v1 = v2 = -HUGE_VAL;
+			for (int j = 0; j < k; j++)
+			{
+				struct heap *h = prices[j];
+				double v = -cost[(size_t)i*k + j] + heap_key(h, heap_top(h));
+				
+				if (v > v1)
+				{
+					v2 = v1;
+					v1 = v, best = j;
+				}
+				else if (v > v2)
+					v2 = v;
+			}
+			if (heap_next(prices[best]) >= 0)
+			{
+				double v = -cost[(size_t)i*k + best] + heap_key(prices[best], heap_next(prices[best]));
+				
+				if (v > v2)
+					v2 = v;
+			}
+			
+			/* Bid. Prices are stored negated in the max-heap. */
+			increment = ((v2 > -HUGE_VAL) ? v1 - v2 : 0.0) + eps;
+			s = heap_top(prices[best]);
+			heap_update(prices[best], s, heap_key(prices[best], s) - increment);
+			
+			/* Outbid the current owner. */
+			s += base[best];
+			if (owner[s] >= 0)
+				queue[(head + nqueued++)%n] = owner[s];
+			owner[s] = i;
+			balanced_map[i] = best;
 		}
+		
+		if (eps <= mineps)
+			break;
+		
+		eps /= AUCTION_SCALING;
+		if (eps < mineps)
+			eps = mineps;
 	}
 	
-	balanced_map = auction(m, AUCTION_SLACK);
-	
-	/* Fix map. */
-	for (int i = 0; i < kdata->npoints; i++)
-		balanced_map[i] /= procs_per_cluster;
-	
 	/* House keeping. */
-	matrix_destroy(m);
+	for (int j = 0; j < k; j++)
+		heap_destroy(prices[j]);
+	free(prices);
+	free(queue);
+	free(owner);
+	free(cost);
+	free(base);
 	
 	return (balanced_map);
 }
@@ -82,177 +205,361 @@ static int *balance(struct kmeans_data *kdata)
 #else
 
 /**
- * @brief Balances processes evenly among clusters using a greedy strategy.
+ * @brief Candidate cluster of a process.
+ */
+struct candidate
+{
+	double distance; /**< Distance to centroid. */
+	int cluster;     /**< Cluster.              */
+};
+
+/**
+ * @brief Compares two candidate clusters.
+ */
+static int candidate_cmp(const void *a, const void *b)
+{
+	const struct candidate *c0 = a;
+	const struct candidate *c1 = b;
+	
+	if (c0->distance != c1->distance)
+		return ((c0->distance < c1->distance) ? -1 : 1);
+	
+	return (c0->cluster - c1->cluster);
+}
+
+/**
+ * @brief Computes the regret of a process.
  * 
- * @param kdata Kmeans data.
+ * @details Skips clusters that are already full on the preference list of
+ *          process @p i, and returns how much farther it would get if it
+ *          did not join its closest available cluster.
  * 
- * @returns A balanced cluster map.
+ * @param prefs  Preference lists.
+ * @param k      Number of clusters.
+ * @param full   Full clusters.
+ * @param first  Closest available cluster of each process.
+ * @param second Second closest available cluster of each process.
+ * @param i      Target process.
+ * 
+ * @returns The regret of process @p i.
  */
-static int *balance(struct kmeans_data *kdata)
+static double regret
+(const struct candidate *prefs, int k, const bool *full, int *first, int *second, int i)
 {
-	int *balanced_map;     /* Process map. */
-	int procs_per_cluster; /* Gotcha?      */
-	
-	if (kdata->npoints%kdata->ncentroids)
-		error("invalid number of clusters");
+	const struct candidate *pref = &prefs[(size_t)i*k];
 	
-	procs_per_cluster = kdata->npoints/kdata->ncentroids;
+	while (full[pref[first[i]].cluster])
+		first[i]++;
+	if (second[i] <= first[i])
+		second[i] = first[i] + 1;
+	while ((second[i] < k) && (full[pref[second[i]].cluster]))
+		second[i]++;
 	
-	balanced_map = smalloc(kdata->npoints*sizeof(int));
-	memcpy(balanced_map, kdata->map, kdata->npoints*sizeof(int));
+	/* No other choice. */
+	if (second[i] == k)
+		return (HUGE_VAL);
 	
-	/* Balance. */
-	for (int i = 0; i < kdata->ncentroids; i++)
+	return (pref[second[i]].distance - pref[first[i]].distance);
+}
+
+/**
+ * @brief Processes that watch clusters.
+ *
+ * @details Each cluster keeps a list of the processes whose closest or second
+ *          closest available cluster it is, so that their regrets can be
+ *          updated once it fills up. Lists share a pool of nodes, and stale
+ *          entries are harmless.
+ */
+struct watchers
+{
+	int *head;    /**< First node of each cluster (or -1). */
+	int *next;    /**< Next node (or -1).                  */
+	int *procs;   /**< Process of each node.               */
+	int nnodes;   /**< Number of nodes.                    */
+	int maxnodes; /**< Capacity of pool.                   */
+};
+
+/**
+ * @brief Makes a process watch a cluster.
+ */
+static void watch(struct watchers *w, int j, int i)
+{
+	/* Grow pool. */
+	if (w->nnodes == w->maxnodes)
 	{
-		int n1 = kmeans_count_points(balanced_map, kdata->npoints, i);
-		
-		/* Take a processes out from this cluster. */
-		while (n1-- > procs_per_cluster)
-		{
-			int farthest;
-			double d1, d2;
-			
-			/* Get farthest process. */
-			farthest = -1;
-			for (int j = 0; j < kdata->npoints; j++)
-			{
-				if (balanced_map[j] != i)
-					continue;
-				
-				if (farthest < 0)
-				{
-					farthest = j;
-					d1 = vector_distance(kdata->data[j], kdata->centroids[i]);
-					continue;
-				}
-				
-				if ((d2 = vector_distance(kdata->data[j], kdata->centroids[i])) > d1)
-					farthest = j, d2 = d1;
-			}
-			
-			/* Get not crowded cluster. */
-			for (int j = 0; j < kdata->ncentroids; j++)
-			{
-				if ((kmeans_count_points(balanced_map, kdata->npoints, j)) >= procs_per_cluster)
-					continue;
-				
-				balanced_map[farthest] = j;
-			}
-		}
+		w->maxnodes *= 2;
+		w->next = srealloc(w->next, w->maxnodes*sizeof(int));
+		w->procs = srealloc(w->procs, w->maxnodes*sizeof(int));
 	}
 	
-	return (balanced_map);
+	w->procs[w->nnodes] = i;
+	w->next[w->nnodes] = w->head[j];
+	w->head[j] = w->nnodes++;
 }
 
-#endif
-
 /**
- * @brief Internal implementation of table_split().
+ * @brief Updates the regret of a process.
+ * 
+ * @details Process @p i starts watching its new closest and second closest
+ *          available clusters, if they changed.
  */
-static void _table_split
-(struct table *t, int i0, int j0, int height, int width, int size, int depth)
+static double rekey
+(const struct candidate *prefs, int k, const bool *full, int *first, int *second,
+ struct watchers *w, int i)
 {
-	/* Stop condition reached. */
-	if (width*height <= size)
-		return;
+	double r;
+	int f = first[i];
+	int s = second[i];
+	const struct candidate *pref = &prefs[(size_t)i*k];
 	
-	/* Split vertically. */
-	if (width > height)
+	r = regret(prefs, k, full, first, second, i);
+	
+	if (first[i] != f)
+		watch(w, pref[first[i]].cluster, i);
+	if ((second[i] != s) && (second[i] < k))
+		watch(w, pref[second[i]].cluster, i);
+	
+	return (r);
+}
+
+/**
+ * @brief Balances processes evenly among clusters using a greedy strategy.
+ * 
+ * @details Processes join their closest cluster that is not yet full, in
+ *          order of decreasing regret, that is, the distance between their
+ *          closest and second closest available clusters. Processes that
+ *          would lose most by being pushed away are thus placed first.
+ *          Regrets only change when the closest or second closest available
+ *          cluster of a process fills up, and they may grow, so every
+ *          cluster keeps track of the processes that point at it and updates
+ *          them in a max-heap once it fills up. Pointers only move forward,
+ *          so the whole assignment takes O(nk log n), on top of sorting the
+ *          preference lists.
+ * 
+ * @param c Clustering.
+ * 
+ * @returns A balanced cluster map.
+ */
+static int *balance(const struct clustering *c)
+{
+	int n, k;                /* Problem size.               */
+	int *balanced_map;       /* Process map.                */
+	int *load;               /* Processes in each cluster.  */
+	bool *full;              /* Full clusters.              */
+	int *first, *second;     /* Closest available clusters. */
+	struct candidate *prefs; /* Preference lists.           */
+	struct heap *regrets;    /* Processes by regret.        */
+	struct watchers w;       /* Watchers of clusters.       */
+	
+	n = c->npoints;
+	k = c->ncentroids;
+	
+	balanced_map = smalloc(n*sizeof(int));
+	load = scalloc(k, sizeof(int));
+	full = scalloc(k, sizeof(bool));
+	first = scalloc(n, sizeof(int));
+	second = scalloc(n, sizeof(int));
+	prefs = smalloc((size_t)n*k*sizeof(struct candidate));
+	regrets = heap_create(n);
+	w.head = smalloc(k*sizeof(int));
+	w.nnodes = 0;
+	w.maxnodes = 2*n + 1;
+	w.next = smalloc(w.maxnodes*sizeof(int));
+	w.procs = smalloc(w.maxnodes*sizeof(int));
+	for (int j = 0; j < k; j++)
+		w.head[j] = -1;
+	
+	/* Build preference lists. */
+	#pragma omp parallel for schedule(static)
+	for (int i = 0; i < n; i++)
 	{
-		/* Enumerate region. */
-		for (int i = 0; i < height; i++)
+		struct candidate *pref = &prefs[(size_t)i*k];
+		
+		for (int j = 0; j < k; j++)
 		{
-			for (int j = 0; j < width/2; j++)
-				*INTP(table_get(t, i0 + i, j0 + j)) |= 0 << depth;
-			for (int j = width/2; j < width; j++)
-				*INTP(table_get(t, i0 + i, j0 + j)) |= 1 << depth;
+			pref[j].distance = features_distance(c->points, clustering_point(c, i), features_row(c->centroids, j));
+			pref[j].cluster = j;
 		}
+		qsort(pref, k, sizeof(struct candidate), candidate_cmp);
+	}
+	
+	for (int i = 0; i < n; i++)
+	{
+		const struct candidate *pref = &prefs[(size_t)i*k];
 		
-		_table_split(t, i0, j0, height, width/2, size, depth + 1);
-		_table_split(t, i0, j0 + width/2, height, width/2, size, depth + 1);
+		heap_insert(regrets, i, regret(prefs, k, full, first, second, i));
+		watch(&w, pref[first[i]].cluster, i);
+		if (second[i] < k)
+			watch(&w, pref[second[i]].cluster, i);
 	}
 	
-	/* Split horizontally. */
-	else
+	/* Balance. */
+	while (!heap_empty(regrets))
 	{
-		/* Enumerate region. */
-		for (int j = 0; j < width; j++)
+		int j;
+		int i = heap_pop(regrets);
+		
+		j = prefs[(size_t)i*k + first[i]].cluster;
+		
+		/* Sanity check. */
+		assert(!full[j]);
+		
+		balanced_map[i] = j;
+		if (++load[j] < capacity(n, k, j))
+			continue;
+		
+		/* Update regrets of processes that point at a full cluster. */
+		full[j] = true;
+		for (int node = w.head[j]; node >= 0; node = w.next[node])
 		{
-			for (int i = 0; i < height/2; i++)
-				*INTP(table_get(t, i0 + i, j0 + j)) |= 0 << depth;
-			for (int i = height/2; i < width; i++)
-				*INTP(table_get(t, i0 + i, j0 + j)) |= 1 << depth;
+			int p = w.procs[node];
+			
+			if (heap_contains(regrets, p))
+				heap_update(regrets, p, rekey(prefs, k, full, first, second, &w, p));
 		}
-		
-		_table_split(t, i0, j0, height/2, width, size, depth + 1);
-		_table_split(t, i0 + height/2, j0, height/2, width, size, depth + 1);
 	}
+	
+	/* House keeping. */
+	free(w.procs);
+	free(w.next);
+	free(w.head);
+	heap_destroy(regrets);
+	free(prefs);
+	free(second);
+	free(first);
+	free(full);
+	free(load);
+	
+	return (balanced_map);
 }
 
+#endif
+
 /**
- * @brief Splits a table recursively.
+ * @brief Internal implementation of place().
+ * 
+ * @details Clusters are split by the bit of their label at @p depth, and
+ *          cores are cut proportionally to the number of processes on each
+ *          side, until a set of cores is left to a single cluster.
  * 
- * @param t Target table.
+ * @param proc    Processor's information.
+ * @param cores   Cores.
+ * @param labels  Labels of clusters, in ascending order.
+ * @param nlabels Number of clusters.
+ * @param depth   Bit of labels to split on.
+ * @param offsets Offsets of clusters in @p procs.
+ * @param procs   Processes, bucketed by cluster.
+ * @param map     Process map.
  */
-static void table_split(struct table *t, int size)
+static void _place
+(const struct processor *proc, struct corekey *cores, int *labels, int nlabels,
+ int depth, const int *offsets, const int *procs, int *map)
 {
-	/* Create table elements. */
-	for (unsigned i = 0; i < table_height(t); i++)
+	int n;    /* Number of cores.                  */
+	int n0;   /* Number of cores in lower part.    */
+	int k0;   /* Number of clusters in lower part. */
+	int *tmp; /* Labels of upper part.             */
+	
+	/* Fill cores with processes of a single cluster. */
+	if (nlabels == 1)
 	{
-		for (unsigned j = 0; j < table_width(t); j++)
-			table_set(t, i, j, scalloc(1, sizeof(int)));
+		for (int i = offsets[labels[0]]; i < offsets[labels[0] + 1]; i++)
+			map[procs[i]] = cores[i - offsets[labels[0]]].core;
+		return;
 	}
+	
+	/* Split clusters. */
+	tmp = smalloc(nlabels*sizeof(int));
+	n = n0 = k0 = 0;
+	for (int j = 0; j < nlabels; j++)
+	{
+		int size = offsets[labels[j] + 1] - offsets[labels[j]];
 		
-	_table_split(t, 0, 0, table_height(t), table_width(t), size, 0);
+		n += size;
+		if (labels[j] & (1 << depth))
+			tmp[j - k0] = labels[j];
+		else
+			labels[k0++] = labels[j], n0 += size;
+	}
+	memcpy(&labels[k0], tmp, (nlabels - k0)*sizeof(int));
+	free(tmp);
+	
+	/* Cut cores. */
+	if ((k0 > 0) && (k0 < nlabels))
+		processor_order(proc, cores, n, n0);
+	
+	if (k0 > 0)
+		_place(proc, cores, labels, k0, depth + 1, offsets, procs, map);
+	if (k0 < nlabels)
+		_place(proc, cores + n0, labels + k0, nlabels - k0, depth + 1, offsets, procs, map);
 }
 
 /**
  * @brief Places processes in the processor.
  * 
+ * @details Clusters are split recursively by the bits of their labels, which
+ *          are the paths to them in hierarchical kmeans, and the processor
+ *          is split alongside, proportionally to the number of processes on
+ *          each side, so any number of clusters of any size fits any shape
+ *          of processor. Processes are bucketed by cluster with a counting
+ *          sort, and each set of cores is filled in a locality-preserving
+ *          order with processes of its bucket, in O(n).
+ * 
  * @param proc       Processor's information.
- * @param clustermap Process map.
+ * @param clustermap Cluster map.
  * @param nprocs     Number of processes.
  * 
  * @returns Process map.
  */
-static int *place
-(struct processor *proc, int *clustermap, int nprocs, int nclusters)
+static int *place(const struct processor *proc, const int *clustermap, int nprocs)
 {
-	int *map;               /* Process map.        */
-	struct table *clusters;	/* Clustered topology. */
+	int *map;              /* Process map.            */
+	int maxlabel;          /* Highest label plus one. */
+	int *offsets;          /* Offsets of buckets.     */
+	int *procs;            /* Processes by cluster.   */
+	int *labels;           /* Labels of clusters.     */
+	int nlabels;           /* Number of clusters.     */
+	struct corekey *cores; /* Cores.                  */
 	
-	map = smalloc(nprocs*sizeof(int));
-	clusters = table_create(&integer, proc->height, proc->width);
-	
-	table_split(clusters, nprocs/nclusters);
+	/* Sanity check. */
+	assert(nprocs == proc->ncores);
 	
-	/* Place processes in the processor. */
-	for (int i = 0; i < proc->height; i++)
+	maxlabel = 0;
+	for (int i = 0; i < nprocs; i++)
 	{
-		for (int j = 0; j < proc->width; j++)
-		{
-			int c;
-			
-			c = *INTP(table_get(clusters, i, j));
-			for (int k = 0; k < nprocs; k++)
-			{
-				if (clustermap[k] == c)
-				{
-					clustermap[k] = -1;
-					map[k] = i*proc->width + j;
-					break;
-				}
-			}
-		}
+		assert(clustermap[i] >= 0);
+		if (clustermap[i] >= maxlabel)
+			maxlabel = clustermap[i] + 1;
 	}
 	
-	/* House keeping. */
-	for (int i = 0; i < proc->height; i++)
+	/* Bucket processes by cluster. */
+	offsets = scalloc(maxlabel + 1, sizeof(int));
+	for (int i = 0; i < nprocs; i++)
+		offsets[clustermap[i]]++;
+	labels = smalloc(maxlabel*sizeof(int));
+	nlabels = 0;
+	for (int j = 0; j < maxlabel; j++)
 	{
-		for (int j = 0; j < proc->width; j++)
-			free(table_get(clusters, i, j));
+		if (offsets[j] > 0)
+			labels[nlabels++] = j;
+		offsets[j + 1] += offsets[j];
 	}
-	table_destroy(clusters);
+	procs = smalloc(nprocs*sizeof(int));
+	for (int i = nprocs - 1; i >= 0; i--)
+		procs[--offsets[clustermap[i]]] = i;
+	
+	map = smalloc(nprocs*sizeof(int));
+	cores = smalloc(proc->ncores*sizeof(struct corekey));
+	for (int i = 0; i < proc->ncores; i++)
+		cores[i].core = i, cores[i].key = 0;
+	
+	_place(proc, cores, labels, nlabels, 0, offsets, procs, map);
+	
+	/* House keeping. */
+	free(cores);
+	free(procs);
+	free(labels);
+	free(offsets);
 	
 	return (map);
 }
@@ -260,155 +567,283 @@ static int *place
 /**
  * @brief (Balanced) Kmeans clustering.
  * 
- * @param data Data that shall be clustered.
- * @param npoints Number of points that shall be clustered.
+ * @param points     Data points.
+ * @param ids        Points that shall be clustered (NULL for all).
+ * @param npoints    Number of points that shall be clustered.
  * @param ncentroids Number of centroids
+ * @param seed       Private random stream.
+ * @param batch      Mini-batch size (0 for full batches).
  * 
  * @returns A map that indicates in which cluster each data point is located.
  */
-static int *kmeans_balanced(const vector_t *data, int npoints, int ncentroids)
+static int *kmeans_balanced
+(const struct features *points, const int *ids, int npoints, int ncentroids, unsigned *seed, int batch)
 {
-	int *balanced_map;         /* Balanced cluster map. */
-	struct kmeans_data *kdata; /* Kmeans data.          */
+	int *balanced_map;    /* Balanced cluster map. */
+	struct clustering *c; /* Clustering.           */
 	
-	kdata = kmeans(data, npoints, ncentroids, 0.0);
-	balanced_map = balance(kdata);
+	c = kmeans_cluster(points, ids, npoints, ncentroids, batch, seed);
+	balanced_map = balance(c);
 		
 	/* House keeping. */
-	kmeans_data_destroy(kdata);
+	clustering_destroy(c);
 	
 	return (balanced_map);
 }
 
 /**
- * @brief Task.
+ * @brief Derives the random stream of a subtree.
  */
-struct task
+static inline unsigned stream_split(unsigned stream, int child)
 {
-	int mask;
-	int depth;
-	int npoints;
-	int *ids; 
-	vector_t *data;
+	stream = stream*2654435761u ^ (child + 1)*2246822519u;
+	rand_next(&stream);
+	
+	return ((stream != 0) ? stream : 1);
+}
+
+/**
+ * @brief Hierarchical kmeans clustering.
+ */
+struct hierarchy
+{
+	const struct features *points; /**< Data points.                          */
+	int *clustermap;               /**< Cluster map.                          */
+	int batch;                     /**< Mini-batch size (0 for full batches). */
 };
 
+static void _kmeans_hierarchical
+(const struct hierarchy *, int *, int, int, int, unsigned);
+
 /**
- * @brief Creates task.
+ * @brief Spawns the subtrees of a bisection as tasks.
+ * 
+ * @param hier    Hierarchical kmeans clustering.
+ * @param halves  Points of each half.
+ * @param npoints Number of points of each half.
+ * @param depth   Depth of the halves.
+ * @param mask    Cluster bits above the halves.
+ * @param stream  Random stream of the parent.
  */
-static struct task *task_create(int depth, unsigned mask, int npoints)
+static void kmeans_halves
+(const struct hierarchy *hier, int **halves, const int *npoints, int depth, int mask, unsigned stream)
 {
-	struct task *t;
-	
-	t = smalloc(sizeof(struct task));
-	t->data = smalloc(npoints*sizeof(vector_t));
-	t->depth = depth;
-	t->mask = mask;
-	t->ids = smalloc(npoints*sizeof(int));
-	t->npoints = npoints;
+	for (int h = 0; h < 2; h++)
+	{
+		int *half = halves[h];
+		int n = npoints[h];
+		int mask1 = (h << (depth - 1)) | mask;
+		unsigned stream1 = stream_split(stream, h);
+		
+		/* Too small to bisect. */
+		if (n < 4)
+			continue;
+		
+		#pragma omp task firstprivate(half, n, mask1, stream1) if (n > KMEANS_PARALLEL_MIN/8)
+		_kmeans_hierarchical(hier, half, n, depth, mask1, stream1);
+	}
 	
-	return (t);
+	#pragma omp taskwait
 }
 
 /**
- * @brief Destroys a task.
+ * @brief Internal implementation of kmeans_hierarchical().
+ * 
+ * @details Bisects a set of points and recurses on both halves, the first
+ *          half holding the odd point, if any, until halves get smaller than
+ *          four points. Halves are independent, so they are spawned as
+ *          tasks, each one with its own points and random stream, and writes
+ *          to its own entries of the cluster map only. The first bisection
+ *          runs outside of any parallel region, so that its distances are
+ *          computed in parallel.
+ * 
+ * @param hier    Hierarchical kmeans clustering.
+ * @param ids     Points of the subtree.
+ * @param npoints Number of points of the subtree.
+ * @param depth   Depth of the subtree.
+ * @param mask    Cluster bits above the subtree.
+ * @param stream  Random stream of the subtree.
  */
-static void task_destroy(struct task *t)
+static void _kmeans_hierarchical
+(const struct hierarchy *hier, int *ids, int npoints, int depth, int mask, unsigned stream)
 {
-	free(t->data);
-	free(t->ids);
-	free(t);
+	int *partialmap; /* Bisection.        */
+	int *halves[2];  /* Points of halves. */
+	int n[2];        /* Size of halves.   */
+	
+	partialmap = kmeans_balanced(hier->points, ids, npoints, 2, &stream, hier->batch);
+	
+	/* Fix cluster map. */
+	for (int i = 0; i < npoints; i++)
+		hier->clustermap[ids[i]] = (partialmap[i] << depth) | mask;
+	
+	/* Recurse on halves. */
+	if (npoints > 4)
+	{
+		halves[0] = smalloc(capacity(npoints, 2, 0)*sizeof(int));
+		halves[1] = smalloc(capacity(npoints, 2, 1)*sizeof(int));
+		n[0] = n[1] = 0;
+		for (int i = 0; i < npoints; i++)
+			halves[partialmap[i]][n[partialmap[i]]++] = ids[i];
+		
+		if (omp_in_parallel())
+			kmeans_halves(hier, halves, n, depth + 1, mask, stream);
+		else
+		{
+			#pragma omp parallel
+			{
+				#pragma omp single
+				kmeans_halves(hier, halves, n, depth + 1, mask, stream);
+			}
+		}
+		
+		free(halves[1]);
+		free(halves[0]);
+	}
+	
+	/* House keeping. */
+	free(partialmap);
 }
 
 /**
  * @brief (Hierarchical) Kmeans clustering.
  * 
- * @param data Data that shall be clustered.
- * @param npoints Number of points that shall be clustered.
- * @param ncentroids Number of centroids
+ * @details The top bisection works on all points, so it runs alone with
+ *          data-parallel distances. Subtrees below it are independent, and
+ *          run as tasks. Each subtree draws from a random stream derived
+ *          from its position in the tree, so results do not depend on the
+ *          number of threads or on the task schedule.
+ * 
+ * @param points Data points.
+ * @param seed   Random stream.
+ * @param batch  Mini-batch size (0 for full batches).
  * 
  * @returns A map that indicates in which cluster each data point is located.
  */
-static int *kmeans_hierarchical(const vector_t *data, int npoints)
+static int *kmeans_hierarchical(const struct features *points, unsigned seed, int batch)
 {
-	queue_t tasks;   /* Tasks.              */
-	struct task *t;  /* Working task.       */
-	int *clustermap; /* Current clustermap. */
-	
-	clustermap = smalloc(npoints*sizeof(int));
-	tasks = queue_create(NULL);
-	
-	/* Create task. */
-	t = task_create(0, 0, npoints);
+	int *ids;              /* Points.                  */
+	int npoints;           /* Number of points.        */
+	struct hierarchy hier; /* Hierarchical clustering. */
+	
+	npoints = points->npoints;
+	hier.points = points;
+	hier.clustermap = smalloc(npoints*sizeof(int));
+	hier.batch = batch;
+	ids = smalloc(npoints*sizeof(int));
 	for (int i = 0; i < npoints; i++)
-		t->ids[i] = i, t->data[i] = data[i];
+		ids[i] = i;
 	
-	queue_enqueue(tasks, t);
+	_kmeans_hierarchical(&hier, ids, npoints, 0, 0, (seed != 0) ? seed : 1);
 	
-	/* Walk through the hierarychy. */
-	while (!queue_empty(tasks))
+	/* House keeping. */
+	free(ids);
+	
+	return (hier.clustermap);
+}
+
+/**
+ * @brief Runs independent kmeans++ clusterings.
+ *
+ * @details Each run draws from its own random stream, derived from @p seed
+ *          and the run number, and goes all the way through balancing and
+ *          placement. Runs go on in parallel, and the map with the lowest
+ *          hop-bytes is kept, ties going to the lowest run number, so that
+ *          results do not depend on the number of threads.
+ *
+ * @param communication Communication graph.
+ * @param proc          Processor's topology.
+ * @param procs         Processes.
+ * @param nclusters     Number of clusters (0 for hierarchical kmeans).
+ * @param restarts      Number of runs.
+ * @param seed          Seed for randomness.
+ * @param batch         Mini-batch size (0 for full batches).
+ *
+ * @returns The best process map.
+ */
+static int *kmeans_restarts
+(const struct graph *communication, struct processor *proc, const struct features *procs,
+ int nclusters, int restarts, unsigned seed, int batch)
+{
+	int *best;           /* Best process map.      */
+	int bestrun;         /* Run of best map.       */
+	double besthopbytes; /* Hop-bytes of best map. */
+	int nprocs;          /* Number of processes.   */
+	
+	nprocs = communication->nvertices;
+	best = NULL;
+	bestrun = restarts;
+	besthopbytes = 0.0;
+	
+	#pragma omp parallel for schedule(dynamic, 1)
+	for (int r = 0; r < restarts; r++)
 	{
-		int *partialmap;
+		int *map;               /* Process map.    */
+		int *clustermap;        /* Cluster map.    */
+		unsigned stream;        /* Random stream.  */
+		struct evaluation eval; /* Map evaluation. */
 		
-		t = queue_dequeue(tasks);
+		stream = (seed + 1)*2654435761u ^ (r + 1)*2246822519u;
+		if (stream == 0)
+			stream = 1;
 		
-		partialmap = kmeans_balanced(t->data, t->npoints, 2);
+		if (nclusters == 0)
+		{
+			clustermap = kmeans_hierarchical(procs, stream, batch);
+			map = place(proc, clustermap, nprocs);
+		}
+		else
+		{
+			clustermap = kmeans_balanced(procs, NULL, nprocs, nclusters, &stream, batch);
+			map = place(proc, clustermap, nprocs);
+		}
+		free(clustermap);
 		
-		/* Fix cluster map. */
-		for (int i = 0; i < t->npoints; i++)
-			clustermap[t->ids[i]] = (partialmap[i] << t->depth) | t->mask;
+		evaluate(communication, proc, map, &eval);
 		
-		/* Enqueue child tasks. */
-		if (t->npoints > 4)
+		/* Keep the best map. */
+		#pragma omp critical
 		{
-			int mask0, mask1;
-			struct task *t0, *t1;
-			
-			mask0 = (0 << t->depth) | t->mask;
-			mask1 = (1 << t->depth) | t->mask;
-			
-			/* Create tasks. */
-			t0 = task_create(t->depth + 1, mask0, t->npoints/2);
-			t1 = task_create(t->depth + 1, mask1, t->npoints/2);
-			for (int i = 0, i0 = 0, i1 = 0; i < t->npoints; i++)
+			if ((best == NULL) || (eval.hopbytes < besthopbytes) ||
+			    ((eval.hopbytes == besthopbytes) && (r < bestrun)))
 			{
-				if (partialmap[i] == 0)
-					t0->ids[i0] = t->ids[i], t0->data[i0++] = data[t->ids[i]];
-				else
-					t1->ids[i1] = t->ids[i], t1->data[i1++] = data[t->ids[i]];
+				free(best);
+				best = map, bestrun = r, besthopbytes = eval.hopbytes;
 			}
-			
-			queue_enqueue(tasks, t0);
-			queue_enqueue(tasks, t1);
+			else
+				free(map);
 		}
-		
-		/* House keeping. */
-		free(partialmap);
-		task_destroy(t);
 	}
 	
-	/* House keeping. */
-	queue_destroy(tasks);
-	
-	return (clustermap);
+	return (best);
 }
 
 /**
  * @brief Maps processes using kmeans algorithm.
  *
- * @param communication Communication matrix.
+ * @details Kmeans needs one process per core, so if fewer processes
+ *          communicate than there are cores, the graph is padded with
+ *          processes that do not communicate.
+ *
+ * @param communication Communication graph.
  * @param args          Additional arguments.
  *
  * @returns A process map.
  */
-int *map_kmeans(matrix_t communication, void *args)
+int *map_kmeans(const struct graph *communication, void *args)
 {
 	int *map;               /* Process map.           */
 	int *clustermap;        /* Balanced cluster map.  */
 	int nclusters;          /* Number of clusters.    */
 	int hierarchical;       /* Hierarchical mapping?  */
+	int embedding;          /* Spectral dimensions.   */
+	int restarts;           /* Independent runs.      */
+	int minibatch;          /* Mini-batch size.       */
+	unsigned seed;          /* Seed for randomness.   */
 	struct processor *proc; /* Processor's topology.  */
 	int nprocs;             /* Number of processes.   */
-	vector_t *procs;        /* Processes.             */
+	struct features *procs; /* Processes.             */
+	struct graph *padded;   /* Padded graph.          */
 	
 	/* Sanity check. */
 	assert(communication != NULL);
@@ -417,51 +852,91 @@ int *map_kmeans(matrix_t communication, void *args)
 	/* Extract arguments. */
 	hierarchical = ((struct kmeans_args *)args)->hierarchical;
 	nclusters = ((struct kmeans_args *)args)->nclusters;
+	embedding = ((struct kmeans_args *)args)->embedding;
+	restarts = ((struct kmeans_args *)args)->restarts;
+	minibatch = ((struct kmeans_args *)args)->minibatch;
+	seed = ((struct kmeans_args *)args)->seed;
 	proc = ((struct kmeans_args *)args)->proc;
 	
-	nprocs = matrix_height(communication);
+	/* Sanity check. */
+	if (!hierarchical)
+		assert(nclusters > 0);
+	if (communication->nvertices > proc->ncores)
+		error("kmeans strategy requires one process per core");
+	
+	/* Idle cores get processes that do not communicate. */
+	padded = NULL;
+	if (communication->nvertices < proc->ncores)
+		communication = padded = graph_pad(communication, proc->ncores);
 	
-	/* Create processes. */
-	procs = smalloc(nprocs*sizeof(vector_t));
-	for (int i = 0; i < nprocs; i++)
+	nprocs = communication->nvertices;
+	
+	/* Embed processes in a low-dimensional space. */
+	if (embedding > 0)
 	{
-		procs[i] = vector_create(nprocs);
-		for (int j = 0; j < nprocs; j++)
-		{			
-			double a;
+		double *coords;
+		
+		coords = spectral_embedding(communication, embedding);
+		procs = features_create(nprocs, embedding);
+		for (int i = 0; i < nprocs; i++)
+		{
+			float *x = features_row(procs, i);
 			
-			a = matrix_get(communication, i, j);
-			if (hierarchical)
-				vector_set(procs[i], j, (a > 0) ? 1.0/a : a);
-			else
-				vector_set(procs[i], j, a);
+			for (int j = 0; j < embedding; j++)
+				x[j] = coords[(size_t)i*embedding + j];
 		}
+		
+		/* House keeping. */
+		free(coords);
 	}
 	
-	/* Sanity check. */
-	if (!hierarchical)
-		assert(nclusters > 0);
-	assert(nprocs == (proc->height*proc->width));
-
+	/* Create processes out of their traffic. */
+	else
+	{
+		procs = features_create(nprocs, nprocs);
+		for (int i = 0; i < nprocs; i++)
+		{
+			float *x = features_row(procs, i);
+			
+			for (int k = communication->offsets[i]; k < communication->offsets[i + 1]; k++)
+			{			
+				double a;
+				
+				a = communication->weights[k];
+				if (hierarchical)
+					x[communication->adjacency[k]] = (a > 0) ? 1.0/a : a;
+				else
+					x[communication->adjacency[k]] = a;
+			}
+		}
+	}
+	
+	/* Independent kmeans++ runs. */
+	if (restarts > 0)
+		map = kmeans_restarts(communication, proc, procs, (hierarchical) ? 0 : nclusters, restarts, seed, minibatch);
+	
 	/* Hierarchical kmeans. */
-	if (hierarchical)
+	else if (hierarchical)
 	{
-		clustermap = kmeans_hierarchical(procs, nprocs);
-		map = place(proc, clustermap, nprocs, nprocs/2);
+		clustermap = kmeans_hierarchical(procs, randnum(), minibatch);
+		map = place(proc, clustermap, nprocs);
+		free(clustermap);
 	}
 	
 	/* Standard kmeans. */
 	else
 	{
-		clustermap = kmeans_balanced(procs, nprocs, nclusters);
-		map = place(proc, clustermap, nprocs, nclusters);
+		unsigned stream = randnum() | 1;
+		
+		clustermap = kmeans_balanced(procs, NULL, nprocs, nclusters, &stream, minibatch);
+		map = place(proc, clustermap, nprocs);
+		free(clustermap);
 	}
 	
 	/* House keeping. */
-	free(clustermap);
-	for (int i = 0; i < nprocs; i++)
-		vector_destroy(procs[i]);
-	free(procs);
+	features_destroy(procs);
+	if (padded != NULL)
+		graph_destroy(padded);
 	
 	return (map);
 }
@@ -17,16 +17,17 @@
  * along with MyLib. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <assert.h>
+#include <omp.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
 #include <string.h>
 #include <time.h>
 
-#include <mylib/matrix.h>
 #include <mylib/util.h>
-#include <mylib/vector.h>
 
+#include "commfile.h"
 #include "mapper.h"
 
 /**
@@ -36,33 +37,65 @@
 #define USE_KMEANS       (1 << 0)
 #define USE_HIERARCHICAL (1 << 1)
 #define USE_GREEDY       (1 << 2)
+#define USE_REFINE       (1 << 3)
+#define USE_AFFINITY     (1 << 4)
+#define USE_BISECTION    (1 << 5)
 /**@}*/
 
 /* Program arguments. */
 static unsigned flags = 0;                            /* Argument flags.       */
 static FILE *input = NULL;                            /* Input file.           */
 static int nclusters = 0;                             /* Number of clusters.   */
-static struct processor proc = {0, 0, 0, NULL, NULL}; /* Processor's topology. */
+static const char *topology = NULL;                   /* Processor's topology. */
+static FILE *topology_file = NULL;                    /* Topology file.        */
+static int axisweights[NR_AXES] = {1, 1, 1};          /* Link costs per axis.  */
+static int chipcost = 10;                             /* Off-chip link cost.   */
+static int embedding = 0;                             /* Spectral dimensions.  */
+static int restarts = 0;                              /* Kmeans restarts.      */
+static int minibatch = 0;                             /* Kmeans batch size.    */
 static bool verbose = false;                          /* Be verbose.           */
 static unsigned seed = 0;                             /* Seed for randomness.  */
+static int nthreads = 0;                              /* Number of threads.    */
+static const char *heatmap = NULL;                    /* Link heatmap file.    */
 
 /**
  * @brief Number of processes.
  */
 static int nprocs = 0;
 
+/**
+ * @brief Processor's topology.
+ */
+static struct processor *proc = NULL;
+
 /**
  * @brief Prints program usage and exits.
  */
 static void usage(void)
 {
-	printf("Usage: mapper [options] --topology <height>x<width> --input <filename>\n\n");
+	printf("Usage: mapper [options] --topology [<rows>x<cols>:]<height>x<width>[x<depth>][t] --input <filename>\n\n");
+	printf("Use a \"t\" suffix for a torus (e.g. \"--topology 8x8t\")\n");
+	printf("Use a depth for a 3D mesh (e.g. \"--topology 4x4x4\")\n");
+	printf("Use a chip layout for a board of chips (e.g. \"--topology 2x2:4x4\")\n");
+	printf("Use \"--topology-file <filename>\" for an irregular processor\n");
+	printf("Use \"--input -\" to read the standard input\n\n");
 	printf("Brief maps processes on a processor\n\n");
 	printf("Options:\n");
+	printf("    --affinity           use greedy strategy with affinity\n");
+	printf("    --axis-costs <x,y,z> set cost of links along each axis\n");
+	printf("    --bisection          use dual recursive bisection strategy\n");
+	printf("    --embedding <d>      cluster processes in a spectral space\n");
 	printf("    --greedy             use greedy strategy\n");
+	printf("    --heatmap <filename> dump link loads\n");
 	printf("    --help               display this information\n");
 	printf("    --hierarchical       use hierarchical mapping\n");
 	printf("    --kmeans <nclusters> use kmeans strategy\n");
+	printf("    --kmeans-minibatch <b>\n");
+	printf("                         update kmeans centroids from batches of b\n");
+	printf("    --nthreads <value>   set number of working threads\n");
+	printf("    --offchip-cost <n>   set cost of links between chips\n");
+	printf("    --refine             refine map with a local search\n");
+	printf("    --restarts <n>       keep the best of n kmeans++ runs\n");
 	printf("    --seed <value>       set sed value\n");
 	printf("    --verbose            be verbose\n");
 	
@@ -81,7 +114,15 @@ static void readargs(int argc, char **argv)
 		STATE_SET_TOPOLOGY,  /* Set topology file.     */
 		STATE_SET_INPUT,     /* Set input file.        */
 		STATE_SET_SEED,      /* Set seed value.        */
-		STATE_SET_GREEDY     /* Set greedy strategy.   */
+		STATE_SET_NTHREADS,  /* Set number of threads. */
+		STATE_SET_GREEDY,    /* Set greedy strategy.   */
+		STATE_SET_HEATMAP,   /* Set heatmap file.      */
+		STATE_SET_COSTS,     /* Set link costs.        */
+		STATE_SET_CHIPCOST,  /* Set off-chip cost.     */
+		STATE_SET_EMBEDDING, /* Set embedding.         */
+		STATE_SET_RESTARTS,  /* Set kmeans restarts.   */
+		STATE_SET_MINIBATCH, /* Set kmeans batch size. */
+		STATE_LOAD_TOPOLOGY  /* Load topology file.    */
 	};
 	
 	int state;
@@ -105,13 +146,23 @@ static void readargs(int argc, char **argv)
 					
 				/* Set topology file. */
 				case STATE_SET_TOPOLOGY:
-					sscanf(arg, "%u%*c%u", &proc.height, &proc.width);
+					topology = arg;
+					break;
+				
+				/* Load topology file. */
+				case STATE_LOAD_TOPOLOGY:
+					if (topology_file != NULL)
+						fclose(topology_file);
+					if ((topology_file = fopen(arg, "r")) == NULL)
+						error("cannot open topology file");
 					break;
 				
 				/* Set input file. */
 				case STATE_SET_INPUT:
-					if (input != NULL)
-						input = freopen(arg, "r", input);
+					if ((input != NULL) && (input != stdin))
+						fclose(input);
+					if (!strcmp(arg, "-"))
+						input = stdin;
 					else
 						input = fopen(arg, "r");
 					break;
@@ -121,6 +172,42 @@ static void readargs(int argc, char **argv)
 					sscanf(arg, "%u", &seed);
 					break;
 				
+				/* Set number of threads. */
+				case STATE_SET_NTHREADS:
+					nthreads = atoi(arg);
+					break;
+				
+				/* Set heatmap file. */
+				case STATE_SET_HEATMAP:
+					heatmap = arg;
+					break;
+				
+				/* Set link costs. */
+				case STATE_SET_COSTS:
+					if (sscanf(arg, "%d,%d,%d", &axisweights[AXIS_X], &axisweights[AXIS_Y], &axisweights[AXIS_Z]) != 3)
+						error("bad link costs");
+					break;
+				
+				/* Set off-chip link cost. */
+				case STATE_SET_CHIPCOST:
+					chipcost = atoi(arg);
+					break;
+				
+				/* Set spectral embedding. */
+				case STATE_SET_EMBEDDING:
+					embedding = atoi(arg);
+					break;
+				
+				/* Set kmeans restarts. */
+				case STATE_SET_RESTARTS:
+					restarts = atoi(arg);
+					break;
+				
+				/* Set kmeans batch size. */
+				case STATE_SET_MINIBATCH:
+					minibatch = atoi(arg);
+					break;
+				
 				/* Wrong usage. */
 				default:
 					usage();
@@ -143,10 +230,32 @@ static void readargs(int argc, char **argv)
 			state = STATE_SET_INPUT;
 		else if (!strcmp(arg, "--seed"))
 			state = STATE_SET_SEED;
+		else if (!strcmp(arg, "--nthreads"))
+			state = STATE_SET_NTHREADS;
 		else if (!strcmp(arg, "--verbose"))
 			verbose = true;
 		else if (!strcmp(arg, "--greedy"))
 			flags |= USE_GREEDY;
+		else if (!strcmp(arg, "--affinity"))
+			flags |= USE_GREEDY | USE_AFFINITY;
+		else if (!strcmp(arg, "--bisection"))
+			flags |= USE_BISECTION;
+		else if (!strcmp(arg, "--refine"))
+			flags |= USE_REFINE;
+		else if (!strcmp(arg, "--heatmap"))
+			state = STATE_SET_HEATMAP;
+		else if (!strcmp(arg, "--axis-costs"))
+			state = STATE_SET_COSTS;
+		else if (!strcmp(arg, "--offchip-cost"))
+			state = STATE_SET_CHIPCOST;
+		else if (!strcmp(arg, "--embedding"))
+			state = STATE_SET_EMBEDDING;
+		else if (!strcmp(arg, "--restarts"))
+			state = STATE_SET_RESTARTS;
+		else if (!strcmp(arg, "--kmeans-minibatch"))
+			state = STATE_SET_MINIBATCH;
+		else if (!strcmp(arg, "--topology-file"))
+			state = STATE_LOAD_TOPOLOGY;
 	}
 }
 
@@ -157,140 +266,18 @@ static void chkargs(void)
 {
 	if (input == NULL)
 		error("cannot open input file");
-	if ((proc.height == 0) || (proc.width == 0))
+	if ((topology == NULL) && (topology_file == NULL))
 		error("bad processor's dimensions");
 	if ((flags & USE_KMEANS) && (nclusters == 0))
 		error("invalid kmeans parameters");
-}
-
-/**
- * @brief Reads communication matrix.
- * 
- * @param file Target file.
- * 
- * @returns Communication matrix.
- */
-static matrix_t read_communication_matrix(FILE *input)
-{
-	matrix_t m;    /* Communication matrix.        */
-	int size;      /* Size of communication.       */
-	int src, dest; /* Source and target processes. */
-	
-	m = matrix_create(nprocs, nprocs);
-	
-	/* Read communication matrix. */
-	fseek(input, 0, SEEK_SET);
-	while (fscanf(input, "%d %d %d\n", &src, &dest, &size) != EOF)
-	{
-		matrix_set(m, dest, src, matrix_get(m, dest, src) + size);
-		matrix_set(m, src, dest, matrix_get(m, src, dest) + size);
-	}
-	
-	return (m);
-}
-
-/**
- * @brief Returns the core ID of a processor.
- * 
- * @param i Vertical location.
- * @param j Horizontal location.
- * 
- * @returns The core ID of a processor.
- */
-static inline int processor_coreid(int i, int j)
-{
-	return (i*proc.width + j);
-}
-
-/**
- * @brief Setups processor.
- */
-static void processor_setup(void)
-{
-	proc.ncores = proc.height*proc.width;
-	
-	/* Allocate topology. */
-	proc.topology = smalloc(proc.ncores*sizeof(int *));
-	for (int i = 0; i < proc.ncores; i++)
-		proc.topology[i] = scalloc(proc.ncores, sizeof(int));
-	
-	/* Allocate nlinks. */
-	proc.nlinks = scalloc(proc.ncores, sizeof(int));
-	
-	/* Setup. */
-	for (int i = 0; i < proc.height; i++)
-	{
-		for (int j = 0; j < proc.width; j++)
-		{
-			int id;
-			
-			id = processor_coreid(i, j);
-			
-			if ((i - 1) >= 0)
-				proc.topology[id][processor_coreid(i-1,j)]=1, proc.nlinks[id]++;
-			if ((i + 1) < proc.height)
-				proc.topology[id][processor_coreid(i+1,j)]=1, proc.nlinks[id]++;
-			if ((j - 1) >= 0)
-				proc.topology[id][processor_coreid(i,j-1)]=1, proc.nlinks[id]++;
-			if ((j + 1) < proc.width)
-				proc.topology[id][processor_coreid(i,j+1)]=1, proc.nlinks[id]++;
-		}
-	}
-}
-
-/**
- * @brief Destroys processor.
- */
-static void processor_destroy(void)
-{
-	free(proc.nlinks);
-	for (int i = 0; i < proc.ncores; i++)
-		free(proc.topology[i]);
-	free(proc.topology);
-}
-
-/**
- * @brief Evaluates how good a process map is.
- * 
- * @param map     Process map.
- * @param nprocs  Number of processes.
- * @param traffic Communication matrix.
- * 
- * @returns Process map fitness.
- */
-static double evaluate(int *map, int nprocs, matrix_t traffic)
-{
-	double fitness;
-	
-	/* Sanity check. */
-	assert(map != NULL);
-	assert(nprocs > 0);
-	assert(traffic != NULL);
-	
-	/* Evaluate map. */
-	fitness = 0.0;
-	for (int i = 0; i < nprocs; i++)
-	{
-		for (int j = 0; j < nprocs; j++)
-		{
-			int distance;
-			
-			/* Skip this process. */
-			if (j == i)
-				continue;
-		
-			distance = (map[i]/proc.width > map[j]/proc.width) ?
-						map[i]/proc.width - map[j]/proc.width :
-						map[j]/proc.width - map[i]/proc.width +
-					   (map[i]%proc.width > map[j]%proc.width) ?
-					    map[i]%proc.width - map[j]%proc.width :
-					    map[j]%proc.width - map[i]%proc.width;
-						
-			fitness += distance*matrix_get(traffic, i, j);
-		}
-	}
-	
-	return (fitness/(nprocs*nprocs));
+	if (nthreads < 0)
+		error("invalid number of threads");
+	if ((embedding < 0) || (embedding == 1))
+		error("invalid embedding dimensions");
+	if (restarts < 0)
+		error("invalid number of restarts");
+	if (minibatch < 0)
+		error("invalid batch size");
 }
 
 /*
@@ -299,20 +286,46 @@ static double evaluate(int *map, int nprocs, matrix_t traffic)
 int main(int argc, char **argv)
 {
 	int *map;
-	matrix_t m;
+	struct graph *g;
+	struct evaluation eval;
+	struct linkload ll;
 	int strategyid;
 	void *args;
 	struct kmeans_args kmeans_args;
 	struct greedy_args greedy_args;
+	struct bisection_args bisection_args;
 	
 	readargs(argc, argv);
 	chkargs();
+	
+	/* Setup working threads. */
+	if (nthreads > 0)
+	{
+		omp_set_num_threads(nthreads);
+		set_nthreads(nthreads);
+	}
 
-	processor_setup();
+	if (topology_file != NULL)
+	{
+		proc = processor_load(topology_file);
+		fclose(topology_file);
+	}
+	else
+		proc = processor_parse(topology, axisweights, chipcost);
+	if ((heatmap != NULL) && (!proc->regular))
+		error("link loads require a mesh or torus");
 
-	nprocs = proc.height*proc.width;
+	/* Read communication graph. */
+	if (commfile_check(input))
+	{
+		g = commfile_load(input);
+		if (g->nvertices > proc->ncores)
+			error("too many processes");
+	}
+	else
+		g = parse_communication_graph(input, proc->ncores);
 	
-	m = read_communication_matrix(input);
+	nprocs = g->nvertices;
 	
 	srandnum(seed);
 	
@@ -321,37 +334,83 @@ int main(int argc, char **argv)
 	{
 		strategyid = STRATEGY_KMEANS;
 		kmeans_args.nclusters = nclusters;
-		kmeans_args.proc = &proc;
+		kmeans_args.proc = proc;
+		kmeans_args.embedding = embedding;
+		kmeans_args.restarts = restarts;
+		kmeans_args.minibatch = minibatch;
+		kmeans_args.seed = seed;
 		kmeans_args.hierarchical = 0;
 		args = &kmeans_args;
 	}
 	else if (flags & USE_HIERARCHICAL)
 	{
 		strategyid = STRATEGY_KMEANS;
-		kmeans_args.proc = &proc;
+		kmeans_args.proc = proc;
+		kmeans_args.embedding = embedding;
+		kmeans_args.restarts = restarts;
+		kmeans_args.minibatch = minibatch;
+		kmeans_args.seed = seed;
 		kmeans_args.hierarchical = 1;
 		args = &kmeans_args;
 	}
+	else if (flags & USE_BISECTION)
+	{
+		strategyid = STRATEGY_BISECTION;
+		bisection_args.proc = proc;
+		args = &bisection_args;
+	}
 	else
 	{
 		strategyid = STRATEGY_GREEDY;
-		greedy_args.proc = &proc;
+		greedy_args.proc = proc;
+		greedy_args.affinity = (flags & USE_AFFINITY) ? 1 : 0;
 		args = &greedy_args;
 	}
 	
-	map = process_map(m, strategyid, args);
+	map = process_map(g, strategyid, args);
+	
+	if (flags & USE_REFINE)
+		refine(g, proc, map);
 	
 	/* Print map. */
 	for (int i = 0; i < nprocs; i++)
 		printf("%3u %d\n", i, map[i]);
-	if (verbose)
-		fprintf(stderr, " %lf\n", evaluate(map, nprocs, m));
+	if ((verbose) && (!proc->regular))
+	{
+		evaluate(g, proc, map, &eval);
+		fprintf(stderr, " %lf;%d;%lf\n", eval.hopbytes, eval.maxdistance, eval.avgdistance);
+	}
+	else if ((verbose) || (heatmap != NULL))
+	{
+		evaluate(g, proc, map, &eval);
+		evaluate_links(g, proc, map, &ll);
+		
+		if (verbose)
+		{
+			fprintf(stderr, " %lf;%d;%lf;%lf;%lf\n",
+				eval.hopbytes, eval.maxdistance, eval.avgdistance, ll.maxload, ll.stddev);
+		}
+		
+		/* Dump link loads. */
+		if (heatmap != NULL)
+		{
+			FILE *file;
+			
+			if ((file = fopen(heatmap, "w")) == NULL)
+				error("cannot open heatmap file");
+			linkload_dump(proc, &ll, file);
+			fclose(file);
+		}
+		
+		free(ll.loads);
+	}
 	
 	/* House keeping. */
 	free(map);
-	matrix_destroy(m);
-	processor_destroy();
-	fclose(input);
+	graph_destroy(g);
+	processor_destroy(proc);
+	if (input != stdin)
+		fclose(input);
 	
 	return (0);
 }
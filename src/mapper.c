@@ -21,44 +21,44 @@
 #include <limits.h>
 #include <stdlib.h>
 
-#include <mylib/matrix.h>
-#include <mylib/vector.h>
 #include <mylib/util.h>
 
 #include "mapper.h"
 
 /* Forward definitions. */
-extern int *map_kmeans(matrix_t, void *);
-extern int *map_greedy(matrix_t, void *);
+extern int *map_kmeans(const struct graph *, void *);
+extern int *map_greedy(const struct graph *, void *);
+extern int *map_bisection(const struct graph *, void *);
 
 /**
  * @brief Number of mapping strategies.
  */
-#define NR_STRATEGIES 2
+#define NR_STRATEGIES 3
 
 /**
  * @brief Mapping strategy.
  */
-typedef int *(*strategy)(matrix_t, void *);
+typedef int *(*strategy)(const struct graph *, void *);
 
 /**
  * @brief Mapping strategies.
  */
 static strategy strategies[NR_STRATEGIES] =  {
 	map_kmeans,
-	map_greedy
+	map_greedy,
+	map_bisection
 };
 
 /**
  * @brief Maps process.
  */
-int *process_map(matrix_t communication, int strategy, void *args)
+int *process_map(const struct graph *communication, int strategy, void *args)
 {
 	int *map;
 	
 	/* Sanity check. */
 	assert(communication != NULL);
-	assert(matrix_height(communication) == matrix_width(communication));
+	assert(communication->nvertices > 0);
 	assert(strategy < NR_STRATEGIES);
 	assert(args != NULL);
 	
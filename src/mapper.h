@@ -21,19 +21,168 @@
 #define MAPPER_H_
 
 	#include <stdbool.h>
-
-	#include <mylib/matrix.h>
+	#include <stddef.h>
+	#include <stdint.h>
+	#include <stdio.h>
+	#include <stdlib.h>
+	
+	/**
+	 * @brief Communication record.
+	 */
+	struct edge
+	{
+		int src;     /**< Source process.     */
+		int dest;    /**< Target process.     */
+		double cost; /**< Communication cost. */
+	};
+	
+	/**
+	 * @brief Communication graph (compressed sparse row).
+	 */
+	struct graph
+	{
+		int nvertices;   /**< Number of vertices.         */
+		int nedges;      /**< Number of edges.            */
+		int *offsets;    /**< Offsets of adjacency lists. */
+		int *adjacency;  /**< Adjacency lists.            */
+		double *weights; /**< Edge weights.               */
+		void *base;      /**< Backing file mapping.       */
+		size_t size;     /**< Size of file mapping.       */
+	};
+	
+	/**
+	 * @brief Distance oracles.
+	 */
+	/**@{*/
+	#define DISTANCE_MESH    0 /**< Closed-form mesh distance.   */
+	#define DISTANCE_TORUS   1 /**< Closed-form torus distance.  */
+	#define DISTANCE_TABLE8  2 /**< All-pairs table of uint8_t.  */
+	#define DISTANCE_TABLE16 3 /**< All-pairs table of uint16_t. */
+	#define DISTANCE_CHIPS   4 /**< Closed-form board distance.  */
+	/**@}*/
+	
+	/**
+	 * @brief Processor axes.
+	 */
+	/**@{*/
+	#define AXIS_X  0 /**< Horizontal axis. */
+	#define AXIS_Y  1 /**< Vertical axis.   */
+	#define AXIS_Z  2 /**< Stacking axis.   */
+	#define NR_AXES 3 /**< Number of axes.  */
+	/**@}*/
+	
+	/**
+	 * @brief Chip layout of a processor.
+	 */
+	struct chips
+	{
+		int height; /**< Chip height.            */
+		int width;  /**< Chip width.             */
+		int cost;   /**< Cost of off-chip links. */
+	};
 	
 	/**
 	 * @brief Processor's topology.
 	 */
 	struct processor
 	{
-		int height;     /**< Mesh height.              */
-		int width;      /**< Mesh width.               */
-		int ncores;     /**< Number of cores.          */
-		int **topology; /**< Processor's topology.     */
-		int *nlinks;    /**< Number of links per core. */
+		int height;               /**< Mesh height.                 */
+		int width;                /**< Mesh width.                  */
+		int depth;                /**< Number of layers.            */
+		int ncores;               /**< Number of cores.             */
+		bool torus;               /**< Wraparound links?            */
+		bool regular;             /**< Mesh or torus?               */
+		bool located;             /**< Cores have known locations?  */
+		int axisweights[NR_AXES]; /**< Cost of links along axes.    */
+		struct chips chips;       /**< Chip layout.                 */
+		int *offsets;             /**< Offsets of adjacency lists.  */
+		int *neighbors;           /**< Adjacency lists.             */
+		int *weights;             /**< Link weights (NULL if unit). */
+		int *x;                   /**< Horizontal core location.    */
+		int *y;                   /**< Vertical core location.      */
+		int *z;                   /**< Core layer.                  */
+		int oracle;               /**< Distance oracle.             */
+		void *table;              /**< All-pairs distance table.    */
+	};
+	
+	/**
+	 * @brief Returns the number of links of a core.
+	 */
+	static inline int processor_degree(const struct processor *proc, int c)
+	{
+		return (proc->offsets[c + 1] - proc->offsets[c]);
+	}
+	
+	/**
+	 * @brief Returns the chip of a core.
+	 */
+	static inline int processor_chip(const struct processor *proc, int c)
+	{
+		return ((proc->y[c]/proc->chips.height)*(proc->width/proc->chips.width) +
+		        proc->x[c]/proc->chips.width);
+	}
+	
+	/**
+	 * @brief Returns the distance along an axis of a board of chips.
+	 *
+	 * @details Shortest routes cross exactly as many chip boundaries as the
+	 *          chips of both cores lie apart, and each of these hops costs
+	 *          @p cost instead of @p weight.
+	 */
+	static inline int chip_distance(int a, int b, int size, int weight, int cost)
+	{
+		int d = abs(a - b);
+		int crossings = abs(a/size - b/size);
+		
+		return (weight*(d - crossings) + cost*crossings);
+	}
+	
+	/**
+	 * @brief Returns the distance along a ring.
+	 */
+	static inline int ring_distance(int a, int b, int n)
+	{
+		int d = abs(a - b);
+		
+		return ((d < n - d) ? d : n - d);
+	}
+	
+	/**
+	 * @brief Returns the distance between two cores.
+	 *
+	 * @details Small processors answer from an all-pairs table, whereas large
+	 *          ones use coordinate arithmetic, weighted by the cost of links
+	 *          along each axis.
+	 */
+	static inline int processor_distance(const struct processor *proc, int c0, int c1)
+	{
+		switch (proc->oracle)
+		{
+			case DISTANCE_TABLE8:
+				return (((const uint8_t *)proc->table)[(size_t)c0*proc->ncores + c1]);
+			case DISTANCE_TABLE16:
+				return (((const uint16_t *)proc->table)[(size_t)c0*proc->ncores + c1]);
+			case DISTANCE_TORUS:
+				return (proc->axisweights[AXIS_X]*ring_distance(proc->x[c0], proc->x[c1], proc->width) +
+				        proc->axisweights[AXIS_Y]*ring_distance(proc->y[c0], proc->y[c1], proc->height) +
+				        proc->axisweights[AXIS_Z]*ring_distance(proc->z[c0], proc->z[c1], proc->depth));
+			case DISTANCE_CHIPS:
+				return (chip_distance(proc->x[c0], proc->x[c1], proc->chips.width, proc->axisweights[AXIS_X], proc->chips.cost) +
+				        chip_distance(proc->y[c0], proc->y[c1], proc->chips.height, proc->axisweights[AXIS_Y], proc->chips.cost));
+			default:
+				return (proc->axisweights[AXIS_X]*abs(proc->x[c0] - proc->x[c1]) +
+				        proc->axisweights[AXIS_Y]*abs(proc->y[c0] - proc->y[c1]) +
+				        proc->axisweights[AXIS_Z]*abs(proc->z[c0] - proc->z[c1]));
+		}
+	}
+	
+	/**
+	 * @brief Sort key of a core.
+	 */
+	struct corekey
+	{
+		int key;  /**< Key.  */
+		int core; /**< Core. */
 	};
 	
 	/**
@@ -41,9 +190,13 @@
 	 */
 	struct kmeans_args
 	{
-		int nclusters;          /**< Number of clusters.   */
-		struct processor *proc; /**< Mesh topology.        */
-		int hierarchical : 1;   /**< Hierarchical mapping? */
+		int nclusters;          /**< Number of clusters.                */
+		struct processor *proc; /**< Mesh topology.                     */
+		int embedding;          /**< Spectral dimensions (0 for none).  */
+		int restarts;           /**< Kmeans++ runs (0 for a single).    */
+		int minibatch;          /**< Batch size (0 for full batches).   */
+		unsigned seed;          /**< Seed for randomness.               */
+		int hierarchical : 1;   /**< Hierarchical mapping?              */
 	};
 	
 	/**
@@ -51,18 +204,95 @@
 	 */
 	struct greedy_args
 	{
-		struct processor *proc; /**< Mesh topology. */
+		struct processor *proc; /**< Mesh topology.                   */
+		int affinity : 1;       /**< Affinity to all mapped threads? */
+	};
+	
+	/**
+	 * @brief Bisection strategy arguments.
+	 */
+	struct bisection_args
+	{
+		struct processor *proc; /**< Processor's topology. */
 	};
 	
+	/**
+	 * @brief Process map evaluation.
+	 */
+	struct evaluation
+	{
+		double hopbytes;    /**< Communication volume times distance. */
+		int maxdistance;    /**< Longest communication distance.      */
+		double avgdistance; /**< Volume-weighted average distance.    */
+	};
+	
+	/**
+	 * @brief Link directions.
+	 */
+	/**@{*/
+	#define LINK_EAST          0 /**< Towards higher x.          */
+	#define LINK_WEST          1 /**< Towards lower x.           */
+	#define LINK_NORTH         2 /**< Towards lower y.           */
+	#define LINK_SOUTH         3 /**< Towards higher y.          */
+	#define LINK_UP            4 /**< Towards higher z.          */
+	#define LINK_DOWN          5 /**< Towards lower z.           */
+	#define NR_LINK_DIRECTIONS 6 /**< Number of link directions. */
+	/**@}*/
+	
+	/**
+	 * @brief Link load evaluation.
+	 */
+	struct linkload
+	{
+		int nlinks;     /**< Number of links.                      */
+		double maxload; /**< Load of the most congested link.      */
+		double avgload; /**< Average link load.                    */
+		double stddev;  /**< Standard deviation of link loads.     */
+		double *loads;  /**< Load of each outgoing link, per core. */
+	};
+	
+	/**
+	 * @brief Incremental map evaluator (opaque).
+	 */
+	struct delta;
+	
 	/**
 	 * @brief Mapping strategies.
 	 */
 	/**@{*/
-	#define STRATEGY_KMEANS 0 /**< Kmeans strategy. */
-	#define STRATEGY_GREEDY 1 /**< Greedy strategy. */
+	#define STRATEGY_KMEANS    0 /**< Kmeans strategy.    */
+	#define STRATEGY_GREEDY    1 /**< Greedy strategy.    */
+	#define STRATEGY_BISECTION 2 /**< Bisection strategy. */
 	/**@}*/
 
 	/* Forward definitions. */
-	extern int *process_map(matrix_t, int, void *);
+	extern int *process_map(const struct graph *, int, void *);
+	extern struct graph *graph_create(int, const struct edge *, int);
+	extern struct graph *graph_merge(int, const struct edge *const *, const int *, int);
+	extern struct graph *graph_pad(const struct graph *, int);
+	extern void graph_destroy(struct graph *);
+	extern double graph_get(const struct graph *, int, int);
+	extern struct graph *parse_communication_graph(FILE *, int);
+	extern struct processor *processor_create(int, int, int, bool, const int *, const struct chips *);
+	extern struct processor *processor_parse(const char *, const int *, int);
+	extern struct processor *processor_load(FILE *);
+	extern void processor_destroy(struct processor *);
+	extern void processor_order(const struct processor *, struct corekey *, int, int);
+	extern void evaluate(const struct graph *, const struct processor *, const int *, struct evaluation *);
+	extern void evaluate_links(const struct graph *, const struct processor *, const int *, struct linkload *);
+	extern void linkload_dump(const struct processor *, const struct linkload *, FILE *);
+	extern struct delta *delta_create(const struct graph *, const struct processor *, const int *);
+	extern void delta_destroy(struct delta *);
+	extern double delta_cost(const struct delta *);
+	extern const int *delta_map(const struct delta *);
+	extern int delta_owner(const struct delta *, int);
+	extern double delta_swap(const struct delta *, int, int);
+	extern double delta_move(const struct delta *, int, int);
+	extern void delta_apply_swap(struct delta *, int, int);
+	extern void delta_apply_move(struct delta *, int, int);
+	extern void delta_commit(struct delta *);
+	extern void delta_rollback(struct delta *);
+	extern void refine(const struct graph *, const struct processor *, int *);
+	extern double *spectral_embedding(const struct graph *, int);
 
 #endif /* MAPPER_H_ */
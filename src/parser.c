@@ -0,0 +1,401 @@
+/*
+ * Copyright(C) 2015 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Mapper.
+ *
+ * Mapper is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Mapper is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MyLib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <assert.h>
+#include <limits.h>
+#include <omp.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <mylib/util.h>
+
+#include "mapper.h"
+
+/**
+ * @brief Size of input buffer (in bytes).
+ */
+#define PARSER_BUFSIZE (1 << 20)
+
+/**
+ * @brief Minimum size of an input chunk (in bytes).
+ */
+#define PARSER_CHUNKSIZE (1 << 16)
+
+/**
+ * @brief Buffer of communication records.
+ */
+struct edgebuf
+{
+	struct edge *edges; /**< Communication records.            */
+	int nedges;         /**< Number of records.                */
+	int maxedges;       /**< Capacity of buffer.               */
+	int nprocs;         /**< Highest process ID seen plus one. */
+	int maxprocs;       /**< Maximum number of processes.      */
+	int line;           /**< Current line number in chunk.     */
+	const char *origin; /**< Start of input.                   */
+	const char *chunk;  /**< Start of chunk.                   */
+};
+
+/**
+ * @brief Initializes a buffer of communication records.
+ *
+ * @param buf      Target buffer.
+ * @param maxedges Initial capacity of buffer.
+ * @param maxprocs Maximum number of processes.
+ */
+static void edgebuf_init(struct edgebuf *buf, int maxedges, int maxprocs)
+{
+	buf->nedges = 0;
+	buf->maxedges = (maxedges > 1024) ? maxedges : 1024;
+	buf->edges = smalloc(buf->maxedges*sizeof(struct edge));
+	buf->nprocs = 0;
+	buf->maxprocs = maxprocs;
+	buf->line = 1;
+	buf->origin = NULL;
+	buf->chunk = NULL;
+}
+
+/**
+ * @brief Computes the current line number.
+ *
+ * @details Lines of previous chunks are only counted here, so that parsing
+ *          needs no knowledge about other chunks.
+ *
+ * @param buf Buffer of communication records.
+ *
+ * @returns The current line number.
+ */
+static int lineno(const struct edgebuf *buf)
+{
+	int line = buf->line;
+
+	for (const char *p = buf->origin; p < buf->chunk; p++)
+	{
+		if (*p == '\n')
+			line++;
+	}
+
+	return (line);
+}
+
+/**
+ * @brief Asserts if a character is a field separator.
+ */
+static inline bool is_blank(char c)
+{
+	return ((c == ' ') || (c == '\t') || (c == '\r') || (c == ';'));
+}
+
+/**
+ * @brief Parses an integer.
+ *
+ * @param p   Current position.
+ * @param end End of input.
+ * @param val Parsed value (output).
+ * @param buf Communication records (for error reporting).
+ *
+ * @returns The position right after the parsed integer.
+ */
+static inline const char *parse_int
+(const char *p, const char *end, int *val, const struct edgebuf *buf)
+{
+	bool negative; /* Negative value? */
+	long long acc; /* Accumulator.    */
+
+	/* Skip blanks. */
+	while ((p < end) && (is_blank(*p)))
+		p++;
+
+	negative = false;
+	if ((p < end) && (*p == '-'))
+		negative = true, p++;
+
+	if ((p == end) || (*p < '0') || (*p > '9'))
+		error("bad communication record (line %d)", lineno(buf));
+
+	/* Parse digits. */
+	acc = 0;
+	while ((p < end) && (*p >= '0') && (*p <= '9'))
+	{
+		acc = acc*10 + (*p++ - '0');
+		if (acc > INT_MAX)
+			error("value out of range (line %d)", lineno(buf));
+	}
+
+	*val = (negative) ? -acc : acc;
+
+	return (p);
+}
+
+/**
+ * @brief Parses communication records.
+ *
+ * @param begin Start of input.
+ * @param end   End of input.
+ * @param buf   Communication records.
+ */
+static void parse_range(const char *begin, const char *end, struct edgebuf *buf)
+{
+	const char *p;
+
+	p = begin;
+	while (p < end)
+	{
+		int src, dest, size;
+
+		/* Skip blanks. */
+		while ((p < end) && (is_blank(*p)))
+			p++;
+		if (p == end)
+			break;
+
+		/* Empty line. */
+		if (*p == '\n')
+		{
+			buf->line++, p++;
+			continue;
+		}
+
+		p = parse_int(p, end, &src, buf);
+		p = parse_int(p, end, &dest, buf);
+		p = parse_int(p, end, &size, buf);
+
+		/* Skip trailing blanks. */
+		while ((p < end) && (is_blank(*p)))
+			p++;
+		if ((p < end) && (*p != '\n'))
+			error("bad communication record (line %d)", lineno(buf));
+
+		/* Bad process ID. */
+		if ((src < 0) || (src >= buf->maxprocs))
+			error("process %d out of range (line %d)", src, lineno(buf));
+		if ((dest < 0) || (dest >= buf->maxprocs))
+			error("process %d out of range (line %d)", dest, lineno(buf));
+
+		/* Grow records buffer. */
+		if (buf->nedges == buf->maxedges)
+		{
+			buf->maxedges *= 2;
+			buf->edges = srealloc(buf->edges, buf->maxedges*sizeof(struct edge));
+		}
+
+		buf->edges[buf->nedges].src = src;
+		buf->edges[buf->nedges].dest = dest;
+		buf->edges[buf->nedges].cost = size;
+		buf->nedges++;
+
+		if (src >= buf->nprocs)
+			buf->nprocs = src + 1;
+		if (dest >= buf->nprocs)
+			buf->nprocs = dest + 1;
+	}
+}
+
+/**
+ * @brief Parses a communication file in parallel.
+ *
+ * @details Maps @p file in memory and splits it into newline-aligned chunks,
+ *          which are parsed by different threads into private buffers of
+ *          communication records.
+ *
+ * @param file     Input file.
+ * @param size     File size.
+ * @param maxprocs Maximum number of processes.
+ *
+ * @returns A communication graph.
+ */
+static struct graph *parse_mapped(FILE *file, size_t size, int maxprocs)
+{
+	char *data;                 /* File mapping.            */
+	int nchunks;                /* Number of chunks.        */
+	int nprocs;                 /* Number of processes.     */
+	size_t *bounds;             /* Chunk boundaries.        */
+	int *nedges;                /* Records per chunk.       */
+	const struct edge **edges;  /* Records of each chunk.   */
+	struct edgebuf *bufs;       /* Buffers of each chunk.   */
+	struct graph *g;            /* Communication graph.     */
+
+	data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fileno(file), 0);
+	if (data == MAP_FAILED)
+		error("cannot map communication file");
+
+	/* Split input into newline-aligned chunks. */
+	nchunks = omp_get_max_threads();
+	if ((size_t)nchunks > size/PARSER_CHUNKSIZE)
+		nchunks = size/PARSER_CHUNKSIZE;
+	if (nchunks < 1)
+		nchunks = 1;
+	bounds = smalloc((nchunks + 1)*sizeof(size_t));
+	bounds[0] = 0;
+	bounds[nchunks] = size;
+	for (int i = 1; i < nchunks; i++)
+	{
+		size_t b = (size/nchunks)*i;
+
+		if (b < bounds[i - 1])
+			b = bounds[i - 1];
+		while ((b < size) && (data[b - 1] != '\n'))
+			b++;
+		bounds[i] = b;
+	}
+
+	bufs = smalloc(nchunks*sizeof(struct edgebuf));
+	edges = smalloc(nchunks*sizeof(struct edge *));
+	nedges = smalloc(nchunks*sizeof(int));
+
+	/* Parse chunks. */
+	#pragma omp parallel for schedule(static, 1) num_threads(nchunks)
+	for (int i = 0; i < nchunks; i++)
+	{
+		struct edgebuf *buf = &bufs[i];
+
+		edgebuf_init(buf, (bounds[i + 1] - bounds[i])/8, maxprocs);
+		buf->origin = data;
+		buf->chunk = data + bounds[i];
+
+		parse_range(data + bounds[i], data + bounds[i + 1], buf);
+
+		edges[i] = buf->edges;
+		nedges[i] = buf->nedges;
+	}
+
+	/* Number of processes. */
+	nprocs = 0;
+	for (int i = 0; i < nchunks; i++)
+	{
+		if (bufs[i].nprocs > nprocs)
+			nprocs = bufs[i].nprocs;
+	}
+	if (nprocs == 0)
+		error("empty communication file");
+
+	g = graph_merge(nprocs, edges, nedges, nchunks);
+
+	/* House keeping. */
+	for (int i = 0; i < nchunks; i++)
+		free(bufs[i].edges);
+	free(nedges);
+	free(edges);
+	free(bufs);
+	free(bounds);
+	munmap(data, size);
+
+	return (g);
+}
+
+/**
+ * @brief Parses a communication stream.
+ *
+ * @details Reads communication records out of @p file in a single pass,
+ *          using large buffered reads, so pipes and the standard input are
+ *          supported.
+ *
+ * @param file     Input file.
+ * @param maxprocs Maximum number of processes.
+ *
+ * @returns A communication graph.
+ */
+static struct graph *parse_stream(FILE *file, int maxprocs)
+{
+	char *data;         /* Input buffer.          */
+	size_t len;         /* Bytes in input buffer. */
+	bool eof;           /* End of file reached?   */
+	struct graph *g;    /* Communication graph.   */
+	struct edgebuf buf; /* Communication records. */
+
+	edgebuf_init(&buf, 0, maxprocs);
+
+	data = smalloc(PARSER_BUFSIZE);
+
+	/* Parse input. */
+	len = 0;
+	eof = false;
+	while (!eof)
+	{
+		size_t n;   /* Bytes read.            */
+		size_t end; /* End of complete lines. */
+
+		n = fread(data + len, 1, PARSER_BUFSIZE - len, file);
+		if (n == 0)
+		{
+			if (ferror(file))
+				error("cannot read communication file");
+			eof = true;
+		}
+		len += n;
+
+		/* Look for last complete line. */
+		end = len;
+		if (!eof)
+		{
+			while ((end > 0) && (data[end - 1] != '\n'))
+				end--;
+			if ((end == 0) && (len == PARSER_BUFSIZE))
+				error("line too long (line %d)", buf.line);
+		}
+
+		parse_range(data, data + end, &buf);
+
+		memmove(data, data + end, len - end);
+		len -= end;
+	}
+
+	if (buf.nprocs == 0)
+		error("empty communication file");
+
+	g = graph_create(buf.nprocs, buf.edges, buf.nedges);
+
+	/* House keeping. */
+	free(data);
+	free(buf.edges);
+
+	return (g);
+}
+
+/**
+ * @brief Parses a communication file.
+ *
+ * @details Reads communication records out of @p file. Each record has the
+ *          form "%origin %destin %cost", where fields may also be separated
+ *          by semicolons. The number of processes is the highest process ID
+ *          found plus one. Regular files are parsed in parallel, whereas
+ *          pipes and the standard input are streamed.
+ *
+ * @param file     Input file.
+ * @param maxprocs Maximum number of processes.
+ *
+ * @returns A communication graph.
+ */
+struct graph *parse_communication_graph(FILE *file, int maxprocs)
+{
+	struct stat st;
+
+	/* Sanity check. */
+	assert(file != NULL);
+	assert(maxprocs > 0);
+
+	if ((fstat(fileno(file), &st) == 0) && (S_ISREG(st.st_mode)) && (st.st_size > 0))
+		return (parse_mapped(file, st.st_size, maxprocs));
+
+	return (parse_stream(file, maxprocs));
+}
@@ -0,0 +1,870 @@
+/*
+ * Copyright(C) 2015 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Mapper.
+ *
+ * Mapper is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Mapper is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MyLib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <assert.h>
+#include <omp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <mylib/util.h>
+
+#include "heap.h"
+#include "mapper.h"
+
+/**
+ * @brief Largest processor with an all-pairs distance table.
+ */
+#define PROCESSOR_TABLE_MAX 1024
+
+/**
+ * @brief Computes hop counts from a core.
+ *
+ * @param proc     Target processor.
+ * @param src      Source core.
+ * @param dist     Distances to @p src (output).
+ * @param frontier Breadth-first search queue.
+ */
+static void processor_bfs
+(const struct processor *proc, int src, int *dist, int *frontier)
+{
+	int head, tail;
+
+	for (int i = 0; i < proc->ncores; i++)
+		dist[i] = -1;
+
+	head = tail = 0;
+	dist[src] = 0;
+	frontier[tail++] = src;
+	while (head < tail)
+	{
+		int c = frontier[head++];
+
+		for (int k = proc->offsets[c]; k < proc->offsets[c + 1]; k++)
+		{
+			int i = proc->neighbors[k];
+
+			if (dist[i] >= 0)
+				continue;
+
+			dist[i] = dist[c] + 1;
+			frontier[tail++] = i;
+		}
+	}
+}
+
+/**
+ * @brief Computes weighted distances from a core.
+ *
+ * @param proc Target processor.
+ * @param src  Source core.
+ * @param dist Distances to @p src (output).
+ * @param h    Empty heap with one slot per core.
+ */
+static void processor_dijkstra
+(const struct processor *proc, int src, int *dist, struct heap *h)
+{
+	for (int i = 0; i < proc->ncores; i++)
+		dist[i] = -1;
+
+	/* Closest cores have the largest keys. */
+	dist[src] = 0;
+	heap_insert(h, src, 0.0);
+	while (!heap_empty(h))
+	{
+		int c = heap_pop(h);
+
+		for (int k = proc->offsets[c]; k < proc->offsets[c + 1]; k++)
+		{
+			int i = proc->neighbors[k];
+			int d = dist[c] + proc->weights[k];
+
+			if ((dist[i] >= 0) && (dist[i] <= d))
+				continue;
+
+			if (heap_contains(h, i))
+				heap_update(h, i, -d);
+			else if (dist[i] < 0)
+				heap_insert(h, i, -d);
+			dist[i] = d;
+		}
+	}
+}
+
+/**
+ * @brief Builds an all-pairs distance table.
+ *
+ * @details Runs one breadth-first search per core, or one Dijkstra search if
+ *          links are weighted, in parallel, over the adjacency lists of the
+ *          processor. Distances are stored in the narrowest type that fits
+ *          the diameter.
+ *
+ * @param proc Target processor.
+ */
+static void processor_table(struct processor *proc)
+{
+	int n;        /* Number of cores. */
+	int diameter; /* Diameter.        */
+	int *table;   /* Distances.       */
+
+	n = proc->ncores;
+	table = smalloc((size_t)n*n*sizeof(int));
+
+	diameter = 0;
+	#pragma omp parallel reduction(max:diameter)
+	{
+		int *frontier = NULL;
+		struct heap *h = NULL;
+
+		if (proc->weights != NULL)
+			h = heap_create(n);
+		else
+			frontier = smalloc(n*sizeof(int));
+
+		#pragma omp for schedule(dynamic, 16)
+		for (int src = 0; src < n; src++)
+		{
+			int *dist = &table[(size_t)src*n];
+
+			if (h != NULL)
+				processor_dijkstra(proc, src, dist, h);
+			else
+				processor_bfs(proc, src, dist, frontier);
+
+			for (int i = 0; i < n; i++)
+			{
+				if (dist[i] < 0)
+					error("disconnected processor");
+				if (dist[i] > diameter)
+					diameter = dist[i];
+			}
+		}
+
+		/* House keeping. */
+		if (h != NULL)
+			heap_destroy(h);
+		free(frontier);
+	}
+
+	/* Narrow table. */
+	if (diameter <= UINT8_MAX)
+	{
+		uint8_t *t = smalloc((size_t)n*n*sizeof(uint8_t));
+
+		for (size_t k = 0; k < (size_t)n*n; k++)
+			t[k] = table[k];
+
+		proc->oracle = DISTANCE_TABLE8;
+		proc->table = t;
+	}
+	else
+	{
+		uint16_t *t = smalloc((size_t)n*n*sizeof(uint16_t));
+
+		if (diameter > UINT16_MAX)
+			error("processor is too large");
+
+		for (size_t k = 0; k < (size_t)n*n; k++)
+			t[k] = table[k];
+
+		proc->oracle = DISTANCE_TABLE16;
+		proc->table = t;
+	}
+
+	/* House keeping. */
+	free(table);
+}
+
+/**
+ * @brief Returns the ID of a core in a mesh.
+ *
+ * @param proc Target processor.
+ * @param i    Vertical location.
+ * @param j    Horizontal location.
+ * @param k    Layer.
+ *
+ * @returns The ID of the core at location (@p i, @p j, @p k).
+ */
+static inline int coreid(const struct processor *proc, int i, int j, int k)
+{
+	return ((k*proc->height + i)*proc->width + j);
+}
+
+/**
+ * @brief Adds a link to the adjacency list of a core.
+ *
+ * @details Adjacency lists are kept sorted by neighbor ID. Self-links and
+ *          duplicate links, which wraparound links yield in narrow tori, are
+ *          dropped.
+ *
+ * @param proc   Target processor.
+ * @param id     Core ID.
+ * @param c      ID of neighbor core.
+ * @param nlinks Number of links so far (input and output).
+ */
+static void processor_link(struct processor *proc, int id, int c, int *nlinks)
+{
+	int k;
+
+	if (c == id)
+		return;
+
+	for (k = *nlinks; k > proc->offsets[id]; k--)
+	{
+		if (proc->neighbors[k - 1] == c)
+			return;
+		if (proc->neighbors[k - 1] < c)
+			break;
+	}
+
+	/* Insert link. */
+	for (int i = *nlinks; i > k; i--)
+		proc->neighbors[i] = proc->neighbors[i - 1];
+	proc->neighbors[k] = c;
+	(*nlinks)++;
+}
+
+/**
+ * @brief Creates a mesh or torus processor.
+ *
+ * @details Links of each core are stored as a compressed sparse row
+ *          adjacency, sorted by neighbor ID, so that neighbor enumeration
+ *          costs O(degree) rather than O(ncores). A torus also links cores
+ *          at opposite borders. A processor with more than one layer is a 3D
+ *          mesh (or torus), with vertical links between stacked cores. Links
+ *          along each axis may have distinct costs.
+ *
+ *          A 2D mesh may also be a board of several chips, laid out in a
+ *          grid, with each chip being a mesh of its own. Links between
+ *          chips then have a cost of their own, which replaces the cost of
+ *          the axis.
+ *
+ * @param height  Mesh height.
+ * @param width   Mesh width.
+ * @param depth   Number of layers.
+ * @param torus   Wraparound links?
+ * @param weights Cost of links along each axis (NULL for unit costs).
+ * @param chips   Chip layout (NULL for a single chip).
+ *
+ * @returns A processor.
+ */
+struct processor *processor_create
+(int height, int width, int depth, bool torus, const int *weights, const struct chips *chips)
+{
+	int nlinks;             /* Number of links. */
+	bool unit;              /* Unit costs?      */
+	struct processor *proc; /* Processor.       */
+
+	/* Sanity check. */
+	assert(height > 0);
+	assert(width > 0);
+	assert(depth > 0);
+	assert((chips == NULL) || ((depth == 1) && (!torus)));
+
+	proc = smalloc(sizeof(struct processor));
+	proc->height = height;
+	proc->width = width;
+	proc->depth = depth;
+	proc->ncores = height*width*depth;
+	proc->torus = torus;
+	proc->offsets = smalloc((proc->ncores + 1)*sizeof(int));
+	proc->neighbors = smalloc(NR_AXES*2*proc->ncores*sizeof(int));
+	proc->weights = NULL;
+	proc->x = smalloc(proc->ncores*sizeof(int));
+	proc->y = smalloc(proc->ncores*sizeof(int));
+	proc->z = smalloc(proc->ncores*sizeof(int));
+
+	/* Axis costs. */
+	unit = true;
+	for (int a = 0; a < NR_AXES; a++)
+	{
+		proc->axisweights[a] = (weights != NULL) ? weights[a] : 1;
+		if (proc->axisweights[a] <= 0)
+			error("bad link cost");
+		if (proc->axisweights[a] != 1)
+			unit = false;
+	}
+
+	/* Chip layout. */
+	proc->chips.height = height;
+	proc->chips.width = width;
+	proc->chips.cost = 1;
+	if (chips != NULL)
+	{
+		if ((chips->height <= 0) || (chips->width <= 0) || (chips->cost <= 0))
+			error("bad chip layout");
+		if ((height%chips->height != 0) || (width%chips->width != 0))
+			error("bad chip layout");
+
+		proc->chips = *chips;
+		if ((chips->height < height) || (chips->width < width))
+			unit = false;
+	}
+
+	/* Build adjacency lists. */
+	nlinks = 0;
+	for (int k = 0; k < depth; k++)
+	{
+		for (int i = 0; i < height; i++)
+		{
+			for (int j = 0; j < width; j++)
+			{
+				int id = coreid(proc, i, j, k);
+
+				proc->x[id] = j;
+				proc->y[id] = i;
+				proc->z[id] = k;
+				proc->offsets[id] = nlinks;
+
+				if ((i - 1) >= 0)
+					processor_link(proc, id, coreid(proc, i - 1, j, k), &nlinks);
+				if ((j - 1) >= 0)
+					processor_link(proc, id, coreid(proc, i, j - 1, k), &nlinks);
+				if ((j + 1) < width)
+					processor_link(proc, id, coreid(proc, i, j + 1, k), &nlinks);
+				if ((i + 1) < height)
+					processor_link(proc, id, coreid(proc, i + 1, j, k), &nlinks);
+				if ((k - 1) >= 0)
+					processor_link(proc, id, coreid(proc, i, j, k - 1), &nlinks);
+				if ((k + 1) < depth)
+					processor_link(proc, id, coreid(proc, i, j, k + 1), &nlinks);
+
+				/* Wraparound links. */
+				if (torus)
+				{
+					processor_link(proc, id, coreid(proc, (i + height - 1)%height, j, k), &nlinks);
+					processor_link(proc, id, coreid(proc, i, (j + width - 1)%width, k), &nlinks);
+					processor_link(proc, id, coreid(proc, i, (j + 1)%width, k), &nlinks);
+					processor_link(proc, id, coreid(proc, (i + 1)%height, j, k), &nlinks);
+					processor_link(proc, id, coreid(proc, i, j, (k + depth - 1)%depth), &nlinks);
+					processor_link(proc, id, coreid(proc, i, j, (k + 1)%depth), &nlinks);
+				}
+			}
+		}
+	}
+	proc->offsets[proc->ncores] = nlinks;
+
+	/* Link costs. */
+	if (!unit)
+	{
+		proc->weights = smalloc(nlinks*sizeof(int));
+		for (int c = 0; c < proc->ncores; c++)
+		{
+			for (int k = proc->offsets[c]; k < proc->offsets[c + 1]; k++)
+			{
+				int i = proc->neighbors[k];
+
+				if (processor_chip(proc, i) != processor_chip(proc, c))
+					proc->weights[k] = proc->chips.cost;
+				else if (proc->x[i] != proc->x[c])
+					proc->weights[k] = proc->axisweights[AXIS_X];
+				else if (proc->y[i] != proc->y[c])
+					proc->weights[k] = proc->axisweights[AXIS_Y];
+				else
+					proc->weights[k] = proc->axisweights[AXIS_Z];
+			}
+		}
+	}
+
+	/* Build distance oracle. */
+	proc->regular = true;
+	proc->located = true;
+	proc->oracle = (torus) ? DISTANCE_TORUS : DISTANCE_MESH;
+	if ((proc->chips.height < height) || (proc->chips.width < width))
+		proc->oracle = DISTANCE_CHIPS;
+	proc->table = NULL;
+	if (proc->ncores <= PROCESSOR_TABLE_MAX)
+		processor_table(proc);
+
+	return (proc);
+}
+
+/**
+ * @brief Destroys a processor.
+ *
+ * @param proc Target processor.
+ */
+void processor_destroy(struct processor *proc)
+{
+	/* Sanity check. */
+	assert(proc != NULL);
+
+	free(proc->table);
+	free(proc->z);
+	free(proc->y);
+	free(proc->x);
+	free(proc->weights);
+	free(proc->neighbors);
+	free(proc->offsets);
+	free(proc);
+}
+
+/**
+ * @brief Parses dimensions.
+ *
+ * @param p     Current position.
+ * @param dims  Dimensions (output).
+ * @param ndims Number of dimensions (output).
+ *
+ * @returns The position right after the dimensions.
+ */
+static const char *parse_dims(const char *p, int *dims, int *ndims)
+{
+	int n;
+
+	*ndims = 0;
+	while (true)
+	{
+		if ((*ndims == 3) || (sscanf(p, "%d%n", &dims[*ndims], &n) != 1) || (dims[*ndims] <= 0))
+			error("bad processor's dimensions");
+		p += n;
+		(*ndims)++;
+
+		if ((*p != 'x') && (*p != 'X'))
+			break;
+		p++;
+	}
+	if (*ndims < 2)
+		error("bad processor's dimensions");
+	if (*ndims < 3)
+		dims[2] = 1;
+
+	return (p);
+}
+
+/**
+ * @brief Parses a processor description.
+ *
+ * @details The description has the form "<height>x<width>" for a 2D mesh or
+ *          "<height>x<width>x<depth>" for a 3D mesh, optionally followed by
+ *          "t" for a torus. A board of chips is described by the layout of
+ *          chips followed by the dimensions of each chip, such as "2x2:4x4"
+ *          for four 4x4 chips.
+ *
+ * @param desc     Processor description.
+ * @param weights  Cost of links along each axis (NULL for unit costs).
+ * @param chipcost Cost of links between chips.
+ *
+ * @returns A processor.
+ */
+struct processor *processor_parse(const char *desc, const int *weights, int chipcost)
+{
+	int dims[3];        /* Dimensions.           */
+	int ndims;          /* Number of dimensions. */
+	const char *p;      /* Current position.     */
+	bool torus;         /* Torus?                */
+	struct chips chips; /* Chip layout.          */
+
+	/* Sanity check. */
+	assert(desc != NULL);
+
+	p = parse_dims(desc, dims, &ndims);
+
+	/* Board of chips. */
+	if (*p == ':')
+	{
+		int grid[3];
+
+		if (ndims != 2)
+			error("bad chip layout");
+		grid[0] = dims[0];
+		grid[1] = dims[1];
+
+		p = parse_dims(p + 1, dims, &ndims);
+		if ((ndims != 2) || (*p != '\0'))
+			error("bad processor's topology");
+
+		chips.height = dims[0];
+		chips.width = dims[1];
+		chips.cost = chipcost;
+
+		return (processor_create(grid[0]*dims[0], grid[1]*dims[1], 1, false, weights, &chips));
+	}
+
+	/* Parse suffix. */
+	torus = false;
+	if (*p == 't')
+		torus = true, p++;
+	if (*p != '\0')
+		error("bad processor's topology");
+
+	return (processor_create(dims[0], dims[1], dims[2], torus, weights, NULL));
+}
+
+/**
+ * @brief Link of an irregular processor.
+ */
+struct link
+{
+	int src;  /**< Source core. */
+	int dest; /**< Target core. */
+	int cost; /**< Link cost.   */
+};
+
+/**
+ * @brief Location of a core of an irregular processor.
+ */
+struct location
+{
+	int core;         /**< Core.     */
+	int loc[NR_AXES]; /**< Location. */
+};
+
+/**
+ * @brief Compares two links by source and target cores.
+ */
+static int link_cmp(const void *a, const void *b)
+{
+	const struct link *l0 = a;
+	const struct link *l1 = b;
+
+	if (l0->src != l1->src)
+		return ((l0->src < l1->src) ? -1 : 1);
+	if (l0->dest != l1->dest)
+		return ((l0->dest < l1->dest) ? -1 : 1);
+
+	return ((l0->cost > l1->cost) - (l0->cost < l1->cost));
+}
+
+/**
+ * @brief Loads an irregular processor.
+ *
+ * @details Reads a core graph out of @p file. Each line is either a link,
+ *          "link <core> <core> [<cost>]", or the location of a core,
+ *          "core <core> <x> <y> [<z>]". Links are bidirectional and cost
+ *          one unless stated otherwise. Locations are optional, but when
+ *          given they must be given for all cores. Lines starting with "#"
+ *          are comments. The number of cores is the highest core ID found
+ *          plus one. All-pairs distances are computed up front, so the
+ *          strategies query them in constant time.
+ *
+ * @param file Input file.
+ *
+ * @returns A processor.
+ */
+struct processor *processor_load(FILE *file)
+{
+	char line[1024];        /* Current line.           */
+	int n;                  /* Number of unique links. */
+	int nlinks, maxlinks;   /* Number of links.        */
+	int nlocs, maxlocs;     /* Number of locations.    */
+	bool unit;              /* Unit costs?             */
+	struct link *links;     /* Links.                  */
+	struct location *locs;  /* Core locations.         */
+	struct processor *proc; /* Processor.              */
+
+	/* Sanity check. */
+	assert(file != NULL);
+
+	proc = smalloc(sizeof(struct processor));
+	proc->height = proc->width = proc->depth = 0;
+	proc->ncores = 0;
+	proc->torus = false;
+	proc->regular = false;
+	for (int a = 0; a < NR_AXES; a++)
+		proc->axisweights[a] = 1;
+
+	nlinks = 0;
+	maxlinks = 1024;
+	links = smalloc(maxlinks*sizeof(struct link));
+	nlocs = 0;
+	maxlocs = 64;
+	locs = smalloc(maxlocs*sizeof(struct location));
+
+	/* Parse core graph. */
+	for (int lineno = 1; fgets(line, sizeof(line), file) != NULL; lineno++)
+	{
+		int a, b, c;
+		char keyword[8];
+
+		if ((strchr(line, '\n') == NULL) && (!feof(file)))
+			error("line too long (line %d)", lineno);
+
+		/* Skip comments and empty lines. */
+		if ((sscanf(line, "%7s", keyword) != 1) || (keyword[0] == '#'))
+			continue;
+
+		/* Core location. */
+		if (!strcmp(keyword, "core"))
+		{
+			struct location l;
+
+			l.loc[AXIS_Z] = 0;
+			if (sscanf(line, "%*s %d %d %d %d", &l.core, &l.loc[AXIS_X], &l.loc[AXIS_Y], &l.loc[AXIS_Z]) < 3)
+				error("bad core (line %d)", lineno);
+			if ((l.core < 0) || (l.loc[AXIS_X] < 0) || (l.loc[AXIS_Y] < 0) || (l.loc[AXIS_Z] < 0))
+				error("bad core (line %d)", lineno);
+
+			/* Grow locations buffer. */
+			if (nlocs == maxlocs)
+			{
+				maxlocs *= 2;
+				locs = srealloc(locs, maxlocs*sizeof(struct location));
+			}
+
+			locs[nlocs++] = l;
+			a = b = l.core;
+		}
+
+		/* Link. */
+		else if (!strcmp(keyword, "link"))
+		{
+			c = 1;
+			if ((sscanf(line, "%*s %d %d %d", &a, &b, &c) < 2) || (a < 0) || (b < 0))
+				error("bad link (line %d)", lineno);
+			if (c <= 0)
+				error("bad link cost (line %d)", lineno);
+
+			/* Grow links buffer. */
+			if (nlinks + 2 > maxlinks)
+			{
+				maxlinks *= 2;
+				links = srealloc(links, maxlinks*sizeof(struct link));
+			}
+
+			/* Store both directions. */
+			if (a != b)
+			{
+				links[nlinks].src = a, links[nlinks].dest = b, links[nlinks++].cost = c;
+				links[nlinks].src = b, links[nlinks].dest = a, links[nlinks++].cost = c;
+			}
+		}
+
+		else
+			error("bad topology file (line %d)", lineno);
+
+		if (a >= proc->ncores)
+			proc->ncores = a + 1;
+		if (b >= proc->ncores)
+			proc->ncores = b + 1;
+	}
+
+	if (ferror(file))
+		error("cannot read topology file");
+	if (proc->ncores == 0)
+		error("empty topology file");
+
+	/* Core locations. */
+	proc->x = smalloc(proc->ncores*sizeof(int));
+	proc->y = smalloc(proc->ncores*sizeof(int));
+	proc->z = smalloc(proc->ncores*sizeof(int));
+	for (int i = 0; i < proc->ncores; i++)
+		proc->x[i] = proc->y[i] = proc->z[i] = -1;
+	for (int i = 0; i < nlocs; i++)
+	{
+		proc->x[locs[i].core] = locs[i].loc[AXIS_X];
+		proc->y[locs[i].core] = locs[i].loc[AXIS_Y];
+		proc->z[locs[i].core] = locs[i].loc[AXIS_Z];
+	}
+	proc->located = (nlocs > 0);
+	for (int i = 0; i < proc->ncores; i++)
+	{
+		/* Unlocated cores lie on a line. */
+		if (!proc->located)
+			proc->x[i] = i, proc->y[i] = proc->z[i] = 0;
+		else if (proc->x[i] < 0)
+			error("missing location of core %d", i);
+
+		/* Bounding box. */
+		if (proc->x[i] >= proc->width)
+			proc->width = proc->x[i] + 1;
+		if (proc->y[i] >= proc->height)
+			proc->height = proc->y[i] + 1;
+		if (proc->z[i] >= proc->depth)
+			proc->depth = proc->z[i] + 1;
+	}
+	proc->chips.height = proc->height;
+	proc->chips.width = proc->width;
+	proc->chips.cost = 1;
+
+	/* Build adjacency lists, keeping the cheapest of duplicate links. */
+	qsort(links, nlinks, sizeof(struct link), link_cmp);
+	proc->offsets = scalloc(proc->ncores + 1, sizeof(int));
+	proc->neighbors = smalloc((nlinks + 1)*sizeof(int));
+	proc->weights = smalloc((nlinks + 1)*sizeof(int));
+	n = 0;
+	unit = true;
+	for (int k = 0; k < nlinks; k++)
+	{
+		if ((k > 0) && (links[k].src == links[k - 1].src) && (links[k].dest == links[k - 1].dest))
+			continue;
+
+		proc->offsets[links[k].src + 1]++;
+		proc->neighbors[n] = links[k].dest;
+		proc->weights[n] = links[k].cost;
+		if (links[k].cost != 1)
+			unit = false;
+		n++;
+	}
+	for (int i = 0; i < proc->ncores; i++)
+		proc->offsets[i + 1] += proc->offsets[i];
+	if (unit)
+	{
+		free(proc->weights);
+		proc->weights = NULL;
+	}
+
+	/* Build distance oracle. */
+	processor_table(proc);
+
+	/* House keeping. */
+	free(locs);
+	free(links);
+
+	return (proc);
+}
+
+/**
+ * @brief Compares two cores by key.
+ */
+static int corekey_cmp(const void *a, const void *b)
+{
+	const struct corekey *k0 = a;
+	const struct corekey *k1 = b;
+
+	if (k0->key != k1->key)
+		return ((k0->key < k1->key) ? -1 : 1);
+
+	return ((k0->core > k1->core) - (k0->core < k1->core));
+}
+
+/**
+ * @brief Chooses the axis along which a set of cores is cut.
+ * 
+ * @details Off-chip links are the most expensive ones, so rectangular sets
+ *          of cores that are aligned to chip boundaries are cut between
+ *          chips whenever the lower part holds whole chips. Otherwise, sets
+ *          of cores are cut along their axis of largest extent.
+ * 
+ * @param proc   Processor's information.
+ * @param cores  Cores.
+ * @param n      Number of cores.
+ * @param n0     Number of cores in the lower part.
+ * @param lo     Lowest location along each axis (output).
+ * @param extent Extent along each axis (output).
+ * 
+ * @returns The cut axis.
+ */
+static int cut_axis
+(const struct processor *proc, const struct corekey *cores, int n, int n0, int *lo, int *extent)
+{
+	int axis;            /* Cut axis.    */
+	int nchips[NR_AXES]; /* Chips along. */
+	const int *loc[NR_AXES] = {proc->x, proc->y, proc->z};
+	
+	for (int a = 0; a < NR_AXES; a++)
+	{
+		int hi;
+		
+		lo[a] = hi = loc[a][cores[0].core];
+		for (int i = 1; i < n; i++)
+		{
+			if (loc[a][cores[i].core] < lo[a])
+				lo[a] = loc[a][cores[i].core];
+			if (loc[a][cores[i].core] > hi)
+				hi = loc[a][cores[i].core];
+		}
+		extent[a] = hi - lo[a] + 1;
+	}
+	
+	axis = (extent[AXIS_X] > extent[AXIS_Y]) ? AXIS_X : AXIS_Y;
+	if (extent[AXIS_Z] > extent[axis])
+		axis = AXIS_Z;
+	
+	/* Not a rectangle. */
+	if ((!proc->regular) || (extent[AXIS_X]*extent[AXIS_Y]*extent[AXIS_Z] != n))
+		return (axis);
+	
+	/* Cut between chips. */
+	for (int a = AXIS_X; a <= AXIS_Y; a++)
+	{
+		int chipsize = (a == AXIS_X) ? proc->chips.width : proc->chips.height;
+		int slab = (n/extent[a])*chipsize;
+		
+		nchips[a] = extent[a]/chipsize;
+		if ((lo[a]%chipsize != 0) || (extent[a]%chipsize != 0) || (n0%slab != 0))
+			nchips[a] = 0;
+	}
+	if ((nchips[AXIS_X] > 0) || (nchips[AXIS_Y] > 0))
+		axis = (nchips[AXIS_X] >= nchips[AXIS_Y]) ? AXIS_X : AXIS_Y;
+	
+	return (axis);
+}
+
+/**
+ * @brief Orders a set of cores in a locality-preserving way.
+ * 
+ * @details Cores with known locations are ordered along the cut axis, and
+ *          then back and forth (boustrophedon) along the other axes, so
+ *          that any prefix of the order is a compact set of cores. Other
+ *          cores are ordered by distance to a peripheral core.
+ * 
+ * @param proc  Processor's information.
+ * @param cores Cores.
+ * @param n     Number of cores.
+ * @param n0    Number of cores in the lower part.
+ */
+void processor_order(const struct processor *proc, struct corekey *cores, int n, int n0)
+{
+	/* Order cores along the cut axis. */
+	if (proc->located)
+	{
+		int axis;            /* Cut axis.          */
+		int a1, a2;          /* Other axes.        */
+		int lo[NR_AXES];     /* Lowest locations.  */
+		int extent[NR_AXES]; /* Extents of cores.  */
+		const int *loc[NR_AXES] = {proc->x, proc->y, proc->z};
+		
+		axis = cut_axis(proc, cores, n, n0, lo, extent);
+		a1 = (axis == AXIS_X) ? AXIS_Y : AXIS_X;
+		a2 = (axis == AXIS_Z) ? AXIS_Y : AXIS_Z;
+		
+		for (int i = 0; i < n; i++)
+		{
+			int c = cores[i].core;
+			int p = loc[axis][c] - lo[axis];
+			int q = loc[a1][c] - lo[a1];
+			int r = loc[a2][c] - lo[a2];
+			
+			if (p%2 != 0)
+				q = extent[a1] - 1 - q;
+			q += p*extent[a1];
+			if (q%2 != 0)
+				r = extent[a2] - 1 - r;
+			cores[i].key = q*extent[a2] + r;
+		}
+	}
+	
+	/* Order cores by distance to a peripheral core. */
+	else
+	{
+		int far = cores[0].core;
+		
+		for (int i = 1; i < n; i++)
+		{
+			if (processor_distance(proc, cores[0].core, cores[i].core) > processor_distance(proc, cores[0].core, far))
+				far = cores[i].core;
+		}
+		
+		for (int i = 0; i < n; i++)
+			cores[i].key = processor_distance(proc, far, cores[i].core);
+	}
+	
+	qsort(cores, n, sizeof(struct corekey), corekey_cmp);
+}
@@ -0,0 +1,216 @@
+/*
+ * Copyright(C) 2015 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Mapper.
+ *
+ * Mapper is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Mapper is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MyLib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <assert.h>
+#include <string.h>
+
+#include "mapper.h"
+
+/**
+ * @brief Maximum number of refinement passes.
+ */
+#define REFINE_MAX_PASSES 16
+
+/**
+ * @brief Tries to improve the map by relocating a process.
+ *
+ * @param d    Incremental map evaluator.
+ * @param proc Processor's topology.
+ * @param a    Target process.
+ * @param c    Core around which process @p a should be relocated.
+ *
+ * @returns True if the map was improved, and false otherwise.
+ */
+static bool relocate(struct delta *d, const struct processor *proc, int a, int c)
+{
+	int best;        /* Best core.       */
+	double bestgain; /* Best cost delta. */
+
+	best = -1;
+	bestgain = 0.0;
+
+	/* Look for the best neighbor core. */
+	for (int k = proc->offsets[c]; k < proc->offsets[c + 1]; k++)
+	{
+		int b;
+		double gain;
+		int i = proc->neighbors[k];
+
+		if (i == delta_map(d)[a])
+			continue;
+
+		b = delta_owner(d, i);
+		gain = (b < 0) ? delta_move(d, a, i) : delta_swap(d, a, b);
+
+		if (gain < bestgain)
+			best = i, bestgain = gain;
+	}
+
+	if (best < 0)
+		return (false);
+
+	if (delta_owner(d, best) < 0)
+		delta_apply_move(d, a, best);
+	else
+		delta_apply_swap(d, a, delta_owner(d, best));
+
+	return (true);
+}
+
+/**
+ * @brief Looks for the heaviest communication partner of a process.
+ *
+ * @returns The heaviest communication partner of process @p a, or -1 if
+ *          there is none.
+ */
+static int heaviest_partner(const struct graph *traffic, int a)
+{
+	int best = -1;
+
+	for (int k = traffic->offsets[a]; k < traffic->offsets[a + 1]; k++)
+	{
+		if (traffic->adjacency[k] == a)
+			continue;
+		if ((best < 0) || (traffic->weights[k] > traffic->weights[best]))
+			best = k;
+	}
+
+	return ((best < 0) ? -1 : traffic->adjacency[best]);
+}
+
+/**
+ * @brief Tries to improve the map with a chain of two relocations.
+ *
+ * @details Swaps process @p a with the process next to core @p c whose swap
+ *          costs the least, even if it does not pay off by itself, and then
+ *          lets the displaced process relocate. The chain is kept only if
+ *          the map improves as a whole, and rolled back otherwise.
+ *
+ * @param d       Incremental map evaluator.
+ * @param traffic Communication graph.
+ * @param proc    Processor's topology.
+ * @param a       Target process.
+ * @param c       Core around which process @p a should be relocated.
+ *
+ * @returns True if the map was improved, and false otherwise.
+ */
+static bool chain
+(struct delta *d, const struct graph *traffic, const struct processor *proc, int a, int c)
+{
+	int b;           /* Displaced process. */
+	int partner;     /* Partner of b.      */
+	double cost;     /* Cost before chain. */
+	double bestgain; /* Best cost delta.   */
+
+	/* Journal only holds the chain. */
+	delta_commit(d);
+	cost = delta_cost(d);
+
+	/* Look for the cheapest swap next to core c. */
+	b = -1;
+	bestgain = 0.0;
+	for (int k = proc->offsets[c]; k < proc->offsets[c + 1]; k++)
+	{
+		double gain;
+		int i = delta_owner(d, proc->neighbors[k]);
+
+		if ((i < 0) || (i == a))
+			continue;
+
+		gain = delta_swap(d, a, i);
+		if ((b < 0) || (gain < bestgain))
+			b = i, bestgain = gain;
+	}
+
+	if (b < 0)
+		return (false);
+
+	delta_apply_swap(d, a, b);
+	relocate(d, proc, b, delta_map(d)[b]);
+	partner = heaviest_partner(traffic, b);
+	if ((partner >= 0) && (partner != a))
+		relocate(d, proc, b, delta_map(d)[partner]);
+
+	if (delta_cost(d) < cost)
+	{
+		delta_commit(d);
+		return (true);
+	}
+
+	delta_rollback(d);
+	return (false);
+}
+
+/**
+ * @brief Refines a process map with a local search.
+ *
+ * @details Repeatedly tries to move every process next to its own core and
+ *          next to the core of its heaviest communication partner, either
+ *          to a free core or by swapping places with another process. Moves
+ *          are evaluated incrementally and only improving ones are taken.
+ *          Processes that cannot improve on their own try a chain of two
+ *          relocations next to their partner, which is rolled back unless
+ *          it pays off.
+ *
+ * @param traffic Communication graph.
+ * @param proc    Processor's topology.
+ * @param map     Process map.
+ */
+void refine(const struct graph *traffic, const struct processor *proc, int *map)
+{
+	struct delta *d;
+
+	/* Sanity check. */
+	assert(traffic != NULL);
+	assert(proc != NULL);
+	assert(map != NULL);
+
+	d = delta_create(traffic, proc, map);
+
+	for (int pass = 0; pass < REFINE_MAX_PASSES; pass++)
+	{
+		bool improved = false;
+
+		for (int a = 0; a < traffic->nvertices; a++)
+		{
+			bool moved = false;
+			int partner = heaviest_partner(traffic, a);
+
+			if (relocate(d, proc, a, delta_map(d)[a]))
+				moved = true;
+			if ((partner >= 0) && (relocate(d, proc, a, delta_map(d)[partner])))
+				moved = true;
+			if ((!moved) && (partner >= 0) && (chain(d, traffic, proc, a, delta_map(d)[partner])))
+				moved = true;
+
+			if (moved)
+				improved = true;
+		}
+
+		delta_commit(d);
+
+		if (!improved)
+			break;
+	}
+
+	memcpy(map, delta_map(d), traffic->nvertices*sizeof(int));
+
+	/* House keeping. */
+	delta_destroy(d);
+}
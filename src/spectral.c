@@ -0,0 +1,435 @@
+/*
+ * Copyright(C) 2015 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Mapper.
+ *
+ * Mapper is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Mapper is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MyLib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <mylib/util.h>
+
+#include "mapper.h"
+
+/**
+ * @brief Maximum size of the Krylov basis.
+ */
+#define SPECTRAL_BASIS(d) (2*(d) + 32)
+
+/**
+ * @brief Number of Ritz vectors kept across restarts.
+ */
+#define SPECTRAL_KEEP(d) ((d) + (d)/2 + 4)
+
+/**
+ * @brief Maximum number of restarts.
+ */
+#define SPECTRAL_MAX_RESTARTS 64
+
+/**
+ * @brief Convergence threshold of Ritz pairs.
+ */
+#define SPECTRAL_TOLERANCE 1.0e-4
+
+/**
+ * @brief Maximum number of Jacobi sweeps.
+ */
+#define SPECTRAL_MAX_SWEEPS 64
+
+/**
+ * @brief Normalized Laplacian of a communication graph.
+ */
+struct laplacian
+{
+	const struct graph *g; /**< Communication graph.                   */
+	double *invsqrt;       /**< Inverse square root of vertex degrees. */
+	double *trivial;       /**< Eigenvector of the null eigenvalue.    */
+};
+
+/**
+ * @brief Multiplies a vector by the normalized Laplacian.
+ *
+ * @details Computes y = (I - D^-1/2 W D^-1/2)x, where W holds the weights
+ *          of the communication graph and D its vertex degrees. Self loops
+ *          are ignored.
+ *
+ * @param l Normalized Laplacian.
+ * @param x Input vector.
+ * @param y Output vector.
+ */
+static void laplacian_multiply(const struct laplacian *l, const double *x, double *y)
+{
+	const struct graph *g = l->g;
+
+	#pragma omp parallel for schedule(static)
+	for (int i = 0; i < g->nvertices; i++)
+	{
+		double sum = 0.0;
+
+		for (int k = g->offsets[i]; k < g->offsets[i + 1]; k++)
+		{
+			int j = g->adjacency[k];
+
+			if (j != i)
+				sum += g->weights[k]*l->invsqrt[j]*x[j];
+		}
+
+		y[i] = x[i] - l->invsqrt[i]*sum;
+	}
+}
+
+/**
+ * @brief Returns the dot product of two vectors.
+ */
+static double dot(const double *x, const double *y, int n)
+{
+	double sum = 0.0;
+
+	#pragma omp parallel for schedule(static) reduction(+:sum)
+	for (int i = 0; i < n; i++)
+		sum += x[i]*y[i];
+
+	return (sum);
+}
+
+/**
+ * @brief Computes y = y + a*x.
+ */
+static void axpy(double a, const double *x, double *y, int n)
+{
+	#pragma omp parallel for schedule(static)
+	for (int i = 0; i < n; i++)
+		y[i] += a*x[i];
+}
+
+/**
+ * @brief Diagonalizes a dense symmetric matrix.
+ *
+ * @details Cyclic Jacobi rotations. On return, the diagonal of @p a holds
+ *          the eigenvalues and the columns of @p z the eigenvectors.
+ *
+ * @param a Symmetric matrix (m x m, row-major, destroyed).
+ * @param z Eigenvectors (output, m x m, row-major).
+ * @param m Size of the matrix.
+ */
+static void symmetric_eigen(double *a, double *z, int m)
+{
+	memset(z, 0, (size_t)m*m*sizeof(double));
+	for (int i = 0; i < m; i++)
+		z[i*m + i] = 1.0;
+
+	for (int sweep = 0; sweep < SPECTRAL_MAX_SWEEPS; sweep++)
+	{
+		double off = 0.0;
+		double diag = 0.0;
+
+		for (int p = 0; p < m; p++)
+		{
+			diag += a[p*m + p]*a[p*m + p];
+			for (int q = p + 1; q < m; q++)
+				off += a[p*m + q]*a[p*m + q];
+		}
+		if (off <= 1.0e-30*diag)
+			break;
+
+		for (int p = 0; p < m; p++)
+		{
+			for (int q = p + 1; q < m; q++)
+			{
+				double theta, t, c, s;
+
+				if (a[p*m + q] == 0.0)
+					continue;
+
+				/* Rotation that zeroes a[p][q]. */
+				theta = (a[q*m + q] - a[p*m + p])/(2.0*a[p*m + q]);
+				t = copysign(1.0, theta)/(fabs(theta) + sqrt(theta*theta + 1.0));
+				c = 1.0/sqrt(t*t + 1.0);
+				s = t*c;
+
+				for (int k = 0; k < m; k++)
+				{
+					double kp = a[k*m + p];
+					double kq = a[k*m + q];
+
+					a[k*m + p] = c*kp - s*kq;
+					a[k*m + q] = s*kp + c*kq;
+
+					kp = z[k*m + p];
+					kq = z[k*m + q];
+					z[k*m + p] = c*kp - s*kq;
+					z[k*m + q] = s*kp + c*kq;
+				}
+				for (int k = 0; k < m; k++)
+				{
+					double pk = a[p*m + k];
+					double qk = a[q*m + k];
+
+					a[p*m + k] = c*pk - s*qk;
+					a[q*m + k] = s*pk + c*qk;
+				}
+			}
+		}
+	}
+}
+
+/**
+ * @brief Extends a Lanczos basis.
+ *
+ * @details Multiplies the last basis vector by the normalized Laplacian and
+ *          orthogonalizes the result against the trivial eigenvector and the
+ *          whole basis (twice, which is enough). Projections are recorded in
+ *          the Rayleigh quotient @p h, and the result becomes the next basis
+ *          vector.
+ *
+ * @param l     Normalized Laplacian.
+ * @param basis Krylov basis.
+ * @param h     Rayleigh quotient (m x m, row-major).
+ * @param j     Index of the last basis vector.
+ * @param m     Maximum size of the basis.
+ *
+ * @returns The norm of the new vector, before normalization.
+ */
+static double lanczos_step(const struct laplacian *l, double *basis, double *h, int j, int m)
+{
+	double beta;             /* Norm of new vector. */
+	int n = l->g->nvertices; /* Problem size.       */
+	double *w = &basis[(size_t)(j + 1)*n];
+
+	laplacian_multiply(l, &basis[(size_t)j*n], w);
+
+	for (int i = 0; i <= j; i++)
+		h[i*m + j] = 0.0;
+	for (int pass = 0; pass < 2; pass++)
+	{
+		axpy(-dot(w, l->trivial, n), l->trivial, w, n);
+		for (int i = 0; i <= j; i++)
+		{
+			double c = dot(w, &basis[(size_t)i*n], n);
+
+			axpy(-c, &basis[(size_t)i*n], w, n);
+			h[i*m + j] += c;
+		}
+	}
+	for (int i = 0; i < j; i++)
+		h[j*m + i] = h[i*m + j];
+
+	beta = sqrt(dot(w, w, n));
+	if (beta > 0.0)
+	{
+		for (int i = 0; i < n; i++)
+			w[i] /= beta;
+	}
+
+	return (beta);
+}
+
+/**
+ * @brief Computes a spectral embedding of a communication graph.
+ *
+ * @details Processes are embedded in the space spanned by the eigenvectors
+ *          of the @p d smallest nontrivial eigenvalues of the normalized
+ *          Laplacian of the communication graph, so that heavily
+ *          communicating processes lie close to each other. Eigenvectors
+ *          are computed by thick-restarted Lanczos iterations on the sparse
+ *          matrix: when the basis is full, the best Ritz vectors and the
+ *          last residual direction are kept, and the basis grows again from
+ *          there. Coordinates are finally scaled back by D^-1/2.
+ *
+ * @param g Communication graph.
+ * @param d Number of dimensions.
+ *
+ * @returns Coordinates of processes (nvertices x d, row-major).
+ */
+double *spectral_embedding(const struct graph *g, int d)
+{
+	int n;              /* Number of processes.      */
+	int m;              /* Maximum size of basis.    */
+	int keep;           /* Ritz vectors kept.        */
+	int k;              /* Wanted Ritz vectors.      */
+	int j0;             /* First new basis vector.   */
+	int *order;         /* Ritz values by size.      */
+	double norm;        /* Norm of trivial vector.   */
+	double *coords;     /* Embedding.                */
+	double *basis;      /* Krylov basis.             */
+	double *ritz;       /* Ritz vectors.             */
+	double *r;          /* Residual of a Ritz pair.  */
+	double *h, *a;      /* Rayleigh quotient.        */
+	double *z;          /* Eigenvectors of quotient. */
+	double *theta;      /* Ritz values.              */
+	struct laplacian l; /* Normalized Laplacian.     */
+
+	/* Sanity check. */
+	assert(g != NULL);
+	assert(d > 0);
+
+	n = g->nvertices;
+	coords = scalloc((size_t)n*d, sizeof(double));
+
+	/* Nothing to embed. */
+	if (n < 3)
+		return (coords);
+
+	/* Degrees. */
+	l.g = g;
+	l.invsqrt = smalloc(n*sizeof(double));
+	l.trivial = smalloc(n*sizeof(double));
+	norm = 0.0;
+	for (int i = 0; i < n; i++)
+	{
+		double degree = 0.0;
+
+		for (int e = g->offsets[i]; e < g->offsets[i + 1]; e++)
+		{
+			if (g->adjacency[e] != i)
+				degree += g->weights[e];
+		}
+
+		l.invsqrt[i] = (degree > 0.0) ? 1.0/sqrt(degree) : 0.0;
+		l.trivial[i] = sqrt(degree);
+		norm += degree;
+	}
+	norm = sqrt(norm);
+	for (int i = 0; i < n; i++)
+		l.trivial[i] = (norm > 0.0) ? l.trivial[i]/norm : 0.0;
+
+	/* Trivial eigenvector is left out. */
+	m = SPECTRAL_BASIS(d);
+	if (m > n - 1)
+		m = n - 1;
+	keep = SPECTRAL_KEEP(d);
+	if (keep > m - 1)
+		keep = m - 1;
+	k = (d < keep) ? d : keep;
+
+	basis = smalloc((size_t)(m + 1)*n*sizeof(double));
+	ritz = smalloc((size_t)keep*n*sizeof(double));
+	r = smalloc(n*sizeof(double));
+	h = scalloc((size_t)m*m, sizeof(double));
+	a = smalloc((size_t)m*m*sizeof(double));
+	z = smalloc((size_t)m*m*sizeof(double));
+	theta = smalloc(m*sizeof(double));
+	order = smalloc(m*sizeof(int));
+
+	/* Deterministic starting vector. */
+	for (unsigned i = 0, x = 2463534242u; i < (unsigned)n; i++)
+	{
+		x ^= x << 13, x ^= x >> 17, x ^= x << 5;
+		basis[i] = (double)x/4294967296.0 - 0.5;
+	}
+	axpy(-dot(basis, l.trivial, n), l.trivial, basis, n);
+	norm = sqrt(dot(basis, basis, n));
+	for (int i = 0; i < n; i++)
+		basis[i] /= norm;
+
+	j0 = 0;
+	for (int restart = 0; /* noop */; restart++)
+	{
+		int size;       /* Size of basis.       */
+		bool converged; /* Converged?           */
+
+		/* Grow basis. */
+		size = m;
+		for (int j = j0; j < m; j++)
+		{
+			/* Invariant subspace found. */
+			if (lanczos_step(&l, basis, h, j, m) < 1.0e-10)
+			{
+				size = j + 1;
+				break;
+			}
+		}
+
+		/* Rayleigh-Ritz. */
+		for (int i = 0; i < size; i++)
+		{
+			for (int j = 0; j < size; j++)
+				a[i*size + j] = h[i*m + j];
+		}
+		symmetric_eigen(a, z, size);
+		for (int i = 0; i < size; i++)
+		{
+			int j;
+
+			theta[i] = a[i*size + i];
+			for (j = i; (j > 0) && (theta[order[j - 1]] > theta[i]); j--)
+				order[j] = order[j - 1];
+			order[j] = i;
+		}
+
+		/* Ritz vectors. */
+		#pragma omp parallel for schedule(static)
+		for (int v = 0; v < n; v++)
+		{
+			for (int i = 0; i < keep; i++)
+			{
+				double sum = 0.0;
+
+				if (i < size)
+				{
+					for (int j = 0; j < size; j++)
+						sum += basis[(size_t)j*n + v]*z[j*size + order[i]];
+				}
+
+				ritz[(size_t)i*n + v] = sum;
+			}
+		}
+
+		/* Ritz pairs converge as their residual vanishes. */
+		converged = true;
+		for (int i = 0; (converged) && (i < k) && (i < size); i++)
+		{
+			laplacian_multiply(&l, &ritz[(size_t)i*n], r);
+			axpy(-theta[order[i]], &ritz[(size_t)i*n], r, n);
+			if (sqrt(dot(r, r, n)) > SPECTRAL_TOLERANCE)
+				converged = false;
+		}
+
+		if ((converged) || (size < m) || (restart + 1 == SPECTRAL_MAX_RESTARTS))
+			break;
+
+		/* Thick restart. */
+		memmove(&basis[(size_t)keep*n], &basis[(size_t)m*n], n*sizeof(double));
+		memcpy(basis, ritz, (size_t)keep*n*sizeof(double));
+		memset(h, 0, (size_t)m*m*sizeof(double));
+		for (int i = 0; i < keep; i++)
+			h[i*m + i] = theta[order[i]];
+		j0 = keep;
+	}
+
+	/* Scale back to the random walk Laplacian. */
+	for (int v = 0; v < n; v++)
+	{
+		for (int i = 0; i < k; i++)
+			coords[(size_t)v*d + i] = ritz[(size_t)i*n + v]*l.invsqrt[v];
+	}
+
+	/* House keeping. */
+	free(order);
+	free(theta);
+	free(z);
+	free(a);
+	free(h);
+	free(r);
+	free(ritz);
+	free(basis);
+	free(l.trivial);
+	free(l.invsqrt);
+
+	return (coords);
+}
@@ -0,0 +1,190 @@
+/*
+ * Copyright(C) 2015 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Mapper.
+ *
+ * Mapper is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Mapper is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MyLib. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <mylib/util.h>
+
+#include "../src/commfile.h"
+#include "../src/mapper.h"
+
+/**
+ * @brief Input formats.
+ */
+enum formats
+{
+	FORMAT_TEXT,        /**< %origin %destin %cost          */
+	FORMAT_NAS,         /**< %start %origin %destin %cost   */
+	FORMAT_TRACE_PARSER /**< %origin;%destin;%cost          */
+};
+
+/* Program arguments. */
+static enum formats format = FORMAT_TEXT; /* Input format. */
+static const char *infile = NULL;         /* Input file.   */
+static const char *outfile = NULL;        /* Output file.  */
+
+/**
+ * @brief Prints program usage and exits.
+ */
+static void usage(void)
+{
+	printf("Usage: comm2bin [--nas | --trace-parser] <input> <output>\n");
+	printf("Brief: converts a communication file to the binary format.\n");
+	exit(EXIT_SUCCESS);
+}
+
+/**
+ * @brief Reads command line arguments.
+ */
+static void readargs(int argc, char **argv)
+{
+	int i;
+
+	/* Parse options. */
+	for (i = 1; (i < argc) && (!strncmp(argv[i], "--", 2)); i++)
+	{
+		if (!strcmp(argv[i], "--nas"))
+			format = FORMAT_NAS;
+		else if (!strcmp(argv[i], "--trace-parser"))
+			format = FORMAT_TRACE_PARSER;
+		else
+			usage();
+	}
+
+	/* Missing arguments. */
+	if (argc - i != 2)
+		usage();
+
+	infile = argv[i];
+	outfile = argv[i + 1];
+}
+
+/**
+ * @brief Reads communication records.
+ *
+ * @param file   Input file.
+ * @param nedges Number of records read (output).
+ * @param nprocs Number of processes (output).
+ *
+ * @returns Communication records.
+ */
+static struct edge *read_edges(FILE *file, int *nedges, int *nprocs)
+{
+	int n;              /* Number of records.          */
+	int max;            /* Capacity of records buffer. */
+	int src, dest;      /* Communicating processes.    */
+	int size;           /* Communication size.         */
+	int ret;            /* Scanned items.              */
+	struct edge *edges; /* Communication records.      */
+
+	n = 0;
+	max = 1024;
+	edges = smalloc(max*sizeof(struct edge));
+	*nprocs = 0;
+
+	while (true)
+	{
+		switch (format)
+		{
+			case FORMAT_NAS:
+				ret = fscanf(file, "%*f %d %d %d", &src, &dest, &size);
+				break;
+
+			case FORMAT_TRACE_PARSER:
+				ret = fscanf(file, "%d;%d;%d", &src, &dest, &size);
+				break;
+
+			default:
+				ret = fscanf(file, "%d %d %d", &src, &dest, &size);
+				break;
+		}
+
+		if (ret == EOF)
+			break;
+		if (ret != 3)
+			error("bad input file (record %d)", n);
+		if ((src < 0) || (dest < 0))
+			error("bad process ID (record %d)", n);
+
+		/* Skip empty entries. */
+		if (size == 0)
+			continue;
+
+		/* Grow records buffer. */
+		if (n == max)
+		{
+			max *= 2;
+			edges = srealloc(edges, max*sizeof(struct edge));
+		}
+
+		edges[n].src = src;
+		edges[n].dest = dest;
+		edges[n].cost = size;
+
+		if (src >= *nprocs)
+			*nprocs = src + 1;
+		if (dest >= *nprocs)
+			*nprocs = dest + 1;
+
+		n++;
+	}
+
+	*nedges = n;
+
+	return (edges);
+}
+
+/**
+ * @brief Converts a communication file to the binary format.
+ */
+int main(int argc, char **argv)
+{
+	FILE *in;           /* Input file.            */
+	FILE *out;          /* Output file.           */
+	int nedges;         /* Number of records.     */
+	int nprocs;         /* Number of processes.   */
+	struct edge *edges; /* Communication records. */
+	struct graph *g;    /* Communication graph.   */
+
+	readargs(argc, argv);
+
+	if ((in = fopen(infile, "r")) == NULL)
+		error("cannot open input file");
+
+	edges = read_edges(in, &nedges, &nprocs);
+	if (nprocs == 0)
+		error("empty input file");
+
+	g = graph_create(nprocs, edges, nedges);
+
+	if ((out = fopen(outfile, "wb")) == NULL)
+		error("cannot open output file");
+
+	commfile_store(g, out);
+
+	/* House keeping. */
+	fclose(out);
+	graph_destroy(g);
+	free(edges);
+	fclose(in);
+
+	return (EXIT_SUCCESS);
+}
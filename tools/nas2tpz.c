@@ -41,7 +41,8 @@ static struct
 	unsigned nprocs;    /**< Number of processors. */
 	unsigned nrows;     /**< Number of rows.       */
 	unsigned ncols;     /**< Number of columns.    */
-} topology = { 0, 0, 0 };
+	unsigned nlayers;   /**< Number of layers.     */
+} topology = { 0, 0, 0, 1 };
 
 /**
  * @brief Converts NAS trace file to Topaz input file.
@@ -53,6 +54,9 @@ static void nas2tpz(FILE *nasfilep)
 	unsigned dest;   /* Destination process.   */
 	unsigned source; /* Source process.        */
 	float offset;    /* Time offset.           */
+	unsigned layer;  /* Cores per layer.       */
+	
+	layer = topology.nrows*topology.ncols;
 	
 	/* Convert NAS trace file. */
 	offset = -1.0;
@@ -66,8 +70,8 @@ static void nas2tpz(FILE *nasfilep)
 		
 		fprintf(stdout, "%u %u %u %u %u %u %u %u\n",
 			(unsigned)floor(start),
-			source/topology.ncols, source%topology.ncols, 0,
-			dest/topology.ncols, dest%topology.ncols, 0,
+			(source%layer)/topology.ncols, source%topology.ncols, source/layer,
+			(dest%layer)/topology.ncols, dest%topology.ncols, dest/layer,
 			size);
 	}
 }
@@ -77,7 +81,7 @@ static void nas2tpz(FILE *nasfilep)
  */
 static void usage(void)
 {
-	printf("Usage: nas2tpz <nas file> <nprocs> <height>x<width>\n");
+	printf("Usage: nas2tpz <nas file> <nprocs> <height>x<width>[x<depth>]\n");
 	printf("Brief: converts a NAS trace file to a Topaz input file.\n");
 	exit(EXIT_SUCCESS);
 }
@@ -93,10 +97,11 @@ static void readargs(int argc, char **argv)
 		
 	nasfile = argv[1];
 	sscanf(argv[2], "%u", &topology.nprocs);
-	sscanf(argv[3], "%u%*c%u", &topology.nrows, &topology.ncols);
+	if (sscanf(argv[3], "%u%*c%u%*c%u", &topology.nrows, &topology.ncols, &topology.nlayers) < 2)
+		error("bad topology");
 	
 	/* Bad topology. */
-	if (topology.nrows*topology.ncols != topology.nprocs)
+	if (topology.nrows*topology.ncols*topology.nlayers != topology.nprocs)
 		error("bad topology");
 }
 
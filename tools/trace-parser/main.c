@@ -20,6 +20,7 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 
 #include <mylib/util.h>
 #include <mylib/object.h>
@@ -43,7 +44,7 @@ static char *swapfile = NULL;     /* Swap file.           */
  */
 static void usage(void)
 {
-	printf("usage: trace-parser <trace files> <outputfile>\n");
+	printf("usage: trace-parser <trace files> <swapfile> <outputfile | ->\n");
 	exit(EXIT_SUCCESS);
 }
 
@@ -103,19 +104,23 @@ int main(int argc, char **argv)
 	matrix_generate(swp, m);
 	
 	
-	if ((matrix_shared = fopen(outfile, "w")) == NULL)
+	if (!strcmp(outfile, "-"))
+		matrix_shared = stdout;
+	else if ((matrix_shared = fopen(outfile, "w")) == NULL)
 		error("cannot open output file");
 	
 	fprintf(stderr, "\nGravar matriz no arquivo\n");
 	
+	/* The matrix is symmetric, so each pair is written once. */
 	for (int i = 0; i < ntraces; i++)
 	{
-		for(int j = 0; j < ntraces; j++)
+		for(int j = i; j < ntraces; j++)
 			fprintf(matrix_shared, "%d;%d;%d\n", i, j, (int) matrix_get(m, i, j));	
 	}
 
 	/* House keeping. */
-	fclose(matrix_shared);
+	if (matrix_shared != stdout)
+		fclose(matrix_shared);
 	fclose(swp);
 	
 	fprintf(stderr, "\n\n FIM!\n");